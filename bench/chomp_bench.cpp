@@ -0,0 +1,435 @@
+/// chomp_bench.cpp
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+///
+/// Benchmarks of the core kernels, reported as JSON.
+///
+///   chomp_bench [--quick] [--repeat N] [--cells N] [--seed N] [--threads N]
+///               [--filter SUBSTRING] [--output FILE]
+///
+/// Every input is generated from --seed, so runs with the same arguments
+/// are comparable across releases. Each benchmark also reports a "result"
+/// (e.g. number of critical cells) which must not change between runs.
+
+#include "Integer.h"
+#include "Parallel.h"
+#include "Progress.h"
+#include "Instrumentation.h"
+#include "Iterator.h"
+#include "Chain.h"
+#include "CompressedChains.h"
+#include "Complex.h"
+#include "CubicalComplex.h"
+#include "CubicalSetComplex.h"
+#include "DualComplex.h"
+#include "MorseComplex.h"
+#include "MorseMatching.h"
+#include "MorseMatching.hpp"
+#include "CubicalMorseMatching.h"
+#include "GenericMorseMatching.h"
+#include "Homology.h"
+#include "GradedComplex.h"
+#include "MorseGradedComplex.h"
+#include "ConnectionMatrix.h"
+#include "Grading.h"
+#include "SimplicialComplex.h"
+#include "FlagComplex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// BenchmarkResult
+struct BenchmarkResult {
+  std::string name;
+  std::string input;
+  Integer cells;
+  Integer result;
+  std::vector<double> seconds;
+};
+
+/// Benchmarks
+///   Runs benchmarks and collects their timings
+class Benchmarks {
+public:
+  Benchmarks ( Integer repeat, std::string const& filter ) : repeat_(repeat), filter_(filter) {}
+
+  /// run
+  ///   Time f() "repeat" times. f returns a result which must agree across
+  ///   repetitions; setup() is called (untimed) before each repetition.
+  template < typename Setup, typename F >
+  void
+  run ( std::string const& name, std::string const& input, Integer cells,
+        Setup const& setup, F const& f ) {
+    if ( (name + " " + input).find(filter_) == std::string::npos ) return;
+    BenchmarkResult record;
+    record.name = name;
+    record.input = input;
+    record.cells = cells;
+    for ( Integer r = 0; r < repeat_; ++ r ) {
+      setup();
+      auto start = std::chrono::steady_clock::now();
+      Integer result = f();
+      auto stop = std::chrono::steady_clock::now();
+      record.seconds.push_back(std::chrono::duration<double>(stop - start).count());
+      if ( r > 0 && result != record.result ) {
+        throw std::logic_error(name + " on " + input + " is not reproducible");
+      }
+      record.result = result;
+    }
+    std::cerr << name << " " << input << ": " << *std::min_element(record.seconds.begin(), record.seconds.end()) << "s\n";
+    results_.push_back(record);
+  }
+
+  template < typename F >
+  void
+  run ( std::string const& name, std::string const& input, Integer cells, F const& f ) {
+    run(name, input, cells, [](){}, f);
+  }
+
+  /// json
+  void
+  json ( std::ostream & out, Integer seed, bool quick ) const {
+    out << "{\n  \"seed\": " << seed << ",\n  \"quick\": " << (quick ? "true" : "false")
+        << ",\n  \"threads\": " << num_threads() << ",\n  \"repeat\": " << repeat_
+        << ",\n  \"benchmarks\": [";
+    for ( Integer i = 0; i < (Integer) results_.size(); ++ i ) {
+      auto const& record = results_[i];
+      auto sorted = record.seconds;
+      std::sort(sorted.begin(), sorted.end());
+      double total = 0.0;
+      for ( auto t : sorted ) total += t;
+      out << (i > 0 ? "," : "") << "\n    {\"name\": \"" << record.name << "\""
+          << ", \"input\": \"" << record.input << "\""
+          << ", \"cells\": " << record.cells
+          << ", \"result\": " << record.result
+          << ", \"min_seconds\": " << sorted.front()
+          << ", \"median_seconds\": " << sorted[sorted.size()/2]
+          << ", \"mean_seconds\": " << total / sorted.size() << "}";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+private:
+  Integer repeat_;
+  std::string filter_;
+  std::vector<BenchmarkResult> results_;
+};
+
+/// cubical_input
+///   Grid with about "cells" cells in dimension D
+inline std::vector<Integer>
+cubical_input ( Integer D, Integer cells ) {
+  Integer side = std::max<Integer>(2, std::lround(std::pow(double(cells) / (1L << D), 1.0 / D)));
+  return std::vector<Integer>(D, side);
+}
+
+/// dense_grading
+///   Grade a complex by the minimum of random top cell values over the top star
+inline std::shared_ptr<GradedComplex>
+dense_grading ( std::shared_ptr<Complex> complex, Integer levels, std::mt19937_64 & rng ) {
+  Integer D = complex -> dimension();
+  Integer offset = complex -> size() - complex -> size(D);
+  std::vector<Integer> top ( complex -> size(D) );
+  std::uniform_int_distribution<Integer> level(0, levels - 1);
+  for ( auto & v : top ) v = level(rng);
+  auto grading = construct_grading(complex, [&](Integer x){ return top[x - offset]; });
+  std::vector<Integer> values ( complex -> size() );
+  parallel_for(0, complex -> size(), [&](Integer x){ values[x] = grading(x); });
+  return std::make_shared<GradedComplex>(complex, std::move(values));
+}
+
+/// random_simplices
+///   M random D-simplices on V vertices; vertices of a simplex lie within a
+///   window of "width" consecutive vertices, so the complex has interesting
+///   homology rather than being one big clique
+inline std::vector<Simplex>
+random_simplices ( Integer V, Integer M, Integer D, Integer width, std::mt19937_64 & rng ) {
+  std::uniform_int_distribution<Integer> vertex(0, V - 1);
+  std::uniform_int_distribution<Integer> shift(0, width - 1);
+  std::vector<Simplex> simplices;
+  while ( (Integer) simplices.size() < M ) {
+    Integer v0 = vertex(rng);
+    Simplex s { v0 };
+    while ( (Integer) s.size() < D + 1 ) {
+      Integer v = (v0 + shift(rng)) % V;
+      if ( std::find(s.begin(), s.end(), v) == s.end() ) s.push_back(v);
+    }
+    std::sort(s.begin(), s.end());
+    simplices.push_back(s);
+  }
+  return simplices;
+}
+
+/// lower_star_grading
+///   Grade each simplex by the maximum of random vertex values
+inline std::shared_ptr<GradedComplex>
+lower_star_grading ( std::shared_ptr<SimplicialComplex> complex, Integer V, Integer levels, std::mt19937_64 & rng ) {
+  std::vector<Integer> vertex_value ( V );
+  std::uniform_int_distribution<Integer> level(0, levels - 1);
+  for ( auto & v : vertex_value ) v = level(rng);
+  std::vector<Integer> values ( complex -> size() );
+  for ( auto x : *complex ) {
+    Integer value = 0;
+    for ( auto v : complex -> simplex(x) ) value = std::max(value, vertex_value[v]);
+    values[x] = value;
+  }
+  return std::make_shared<GradedComplex>(complex, std::move(values));
+}
+
+/// sweep
+///   Visit every entry of every column (or row) of the boundary matrix
+inline Integer
+sweep ( Complex const& complex, bool rows ) {
+  Integer total = 0;
+  auto callback = [&](Integer y){ total += y; };
+  for ( auto x : complex ) {
+    if ( rows ) complex.row(x, callback); else complex.column(x, callback);
+  }
+  return total;
+}
+
+/// star_sweep
+///   Visit the top star (or the parallel neighbors) of every cell
+inline Integer
+star_sweep ( CubicalComplex const& complex, bool neighbors ) {
+  Integer total = 0;
+  auto callback = [&](Integer y){ total += y; };
+  for ( auto x : complex ) {
+    if ( neighbors ) complex.parallelneighbors(x, callback); else complex.topstar(x, callback);
+  }
+  return total;
+}
+
+/// cubical_benchmarks
+inline void
+cubical_benchmarks ( Benchmarks & benchmarks, Integer cells, Integer seed ) {
+  for ( Integer D = 2; D <= 6; ++ D ) {
+    auto boxes = cubical_input(D, cells);
+    std::ostringstream ss;
+    ss << "cubical ";
+    for ( Integer d = 0; d < D; ++ d ) ss << (d > 0 ? "x" : "") << boxes[d];
+    std::string input = ss.str();
+    auto X = std::make_shared<CubicalComplex>(boxes);
+    Integer N = X -> size();
+    std::mt19937_64 rng ( seed + D );
+    auto G = dense_grading(X, 16, rng);
+
+    benchmarks.run("boundary sweep", input, N, [&](){ return sweep(*X, false); });
+    benchmarks.run("coboundary sweep", input, N, [&](){ return sweep(*X, true); });
+    benchmarks.run("topstar sweep", input, N, [&](){ return star_sweep(*X, false); });
+    benchmarks.run("parallel neighbors sweep", input, N, [&](){ return star_sweep(*X, true); });
+    benchmarks.run("construct grading", input, N, [&](){
+      std::mt19937_64 r ( seed + D );
+      return dense_grading(X, 16, r) -> value(N - 1);
+    });
+    benchmarks.run("cubical matching", input, N, [&](){
+      CubicalMorseMatching matching ( G );
+      return matching.critical_cells().first.back();
+    });
+    benchmarks.run("generic matching", input, N, [&](){
+      GenericMorseMatching matching ( G );
+      return matching.critical_cells().first.back();
+    });
+    std::shared_ptr<MorseMatching> matching = std::make_shared<CubicalMorseMatching>(G);
+    benchmarks.run("morse complex", input, N, [&](){
+      MorseComplex morse ( X, matching );
+      return morse.size();
+    });
+    benchmarks.run("homology", input, N, [&](){
+      return Homology(X) -> size();
+    });
+    benchmarks.run("connection matrix", input, N, [&](){
+      return ConnectionMatrix(G) -> complex() -> size();
+    });
+  }
+}
+
+/// cubical_box_benchmarks
+///   Non-periodic grids (no fringe cells)
+inline void
+cubical_box_benchmarks ( Benchmarks & benchmarks, Integer cells, Integer seed ) {
+  for ( Integer D = 2; D <= 4; ++ D ) {
+    auto boxes = cubical_input(D, cells);
+    std::ostringstream ss;
+    ss << "cubical box ";
+    for ( Integer d = 0; d < D; ++ d ) ss << (d > 0 ? "x" : "") << boxes[d];
+    std::string input = ss.str();
+    auto X = std::make_shared<CubicalComplex>(boxes, false);
+    Integer N = X -> size();
+    std::mt19937_64 rng ( seed + D );
+    auto G = dense_grading(X, 16, rng);
+
+    benchmarks.run("boundary sweep", input, N, [&](){ return sweep(*X, false); });
+    benchmarks.run("coboundary sweep", input, N, [&](){ return sweep(*X, true); });
+    benchmarks.run("topstar sweep", input, N, [&](){ return star_sweep(*X, false); });
+    benchmarks.run("parallel neighbors sweep", input, N, [&](){ return star_sweep(*X, true); });
+    benchmarks.run("cubical matching", input, N, [&](){
+      CubicalMorseMatching matching ( G );
+      return matching.critical_cells().first.back();
+    });
+    benchmarks.run("connection matrix", input, N, [&](){
+      return ConnectionMatrix(G) -> complex() -> size();
+    });
+    auto dual = std::make_shared<DualComplex>(X);
+    benchmarks.run("dual homology", input, N, [&](){
+      return Homology(dual) -> size();
+    });
+  }
+}
+
+/// cubical_set_benchmarks
+///   Sparse cubical sets: about 5% of the top cells of a grid, in clumps
+inline void
+cubical_set_benchmarks ( Benchmarks & benchmarks, Integer cells, Integer seed ) {
+  for ( Integer D = 2; D <= 3; ++ D ) {
+    // a top cell and its share of faces make about 2^D cells
+    Integer side = std::max<Integer>(4, std::lround(std::pow(20.0 * cells / (1L << D), 1.0 / D)));
+    std::vector<Integer> boxes ( D, side );
+    std::ostringstream ss;
+    ss << "cubical set " << side << "^" << D << " at 5%";
+    std::string input = ss.str();
+    std::mt19937_64 rng ( seed + 200 + D );
+    std::uniform_int_distribution<Integer> coordinate(0, side - 1);
+    std::uniform_int_distribution<Integer> step(-1, 1);
+    Integer T = std::max<Integer>(1, cells / (1L << D));
+    std::vector<Integer> top;
+    std::vector<Integer> x ( D );
+    for ( Integer i = 0; i < T; ++ i ) {
+      // random walk, restarted every 64 steps
+      for ( Integer d = 0; d < D; ++ d ) {
+        x[d] = (i % 64 == 0) ? coordinate(rng) : std::min(side - 1, std::max<Integer>(0, x[d] + step(rng)));
+      }
+      top.insert(top.end(), x.begin(), x.end());
+    }
+    Integer N = CubicalSetComplex(boxes, top.data(), T).size();
+    benchmarks.run("cubical set complex", input, N, [&](){
+      return CubicalSetComplex(boxes, top.data(), T).size();
+    });
+    auto X = std::make_shared<CubicalSetComplex>(boxes, top.data(), T);
+    benchmarks.run("boundary sweep", input, N, [&](){ return sweep(*X, false); });
+    benchmarks.run("coboundary sweep", input, N, [&](){ return sweep(*X, true); });
+    benchmarks.run("homology", input, N, [&](){
+      return Homology(X) -> size();
+    });
+  }
+}
+
+/// simplicial_benchmarks
+inline void
+simplicial_benchmarks ( Benchmarks & benchmarks, Integer cells, Integer seed ) {
+  for ( Integer D = 2; D <= 4; ++ D ) {
+    // a D-simplex has fewer than 2^(D+1) faces, and most faces are shared
+    Integer M = std::max<Integer>(1, cells / (1L << D));
+    Integer V = std::max<Integer>(D + 2, M / 2);
+    std::ostringstream ss;
+    ss << "simplicial V=" << V << " M=" << M << " D=" << D;
+    std::string input = ss.str();
+    std::mt19937_64 rng ( seed + 100 + D );
+    auto simplices = random_simplices(V, M, D, 3 * (D + 1), rng);
+    auto K = std::make_shared<SimplicialComplex>(simplices);
+    Integer N = K -> size();
+    benchmarks.run("simplicial complex", input, N, [&](){
+      return SimplicialComplex(simplices).size();
+    });
+    std::cerr << "simplicial complex " << input << ": " << K -> bytes_per_simplex() << " bytes/simplex\n";
+    benchmarks.run("simplex lookup", input, N, [&](){
+      Integer total = 0;
+      for ( auto x : *K ) total += K -> idx(K -> simplex(x));
+      return total;
+    });
+    auto G = lower_star_grading(K, V, 16, rng);
+
+    benchmarks.run("boundary sweep", input, N, [&](){ return sweep(*K, false); });
+    benchmarks.run("coboundary sweep", input, N, [&](){ return sweep(*K, true); });
+    benchmarks.run("generic matching", input, N, [&](){
+      GenericMorseMatching matching ( G );
+      return matching.critical_cells().first.back();
+    });
+    std::shared_ptr<MorseMatching> matching = std::make_shared<GenericMorseMatching>(G);
+    benchmarks.run("morse complex", input, N, [&](){
+      MorseComplex morse ( K, matching );
+      return morse.size();
+    });
+    benchmarks.run("homology", input, N, [&](){
+      return Homology(K) -> size();
+    });
+    benchmarks.run("connection matrix", input, N, [&](){
+      return ConnectionMatrix(G) -> complex() -> size();
+    });
+  }
+  // Rips complex of random points in the unit cube, about 12 neighbors each
+  Integer n = std::max<Integer>(64, cells / 50);
+  std::ostringstream ss;
+  ss << "flag n=" << n << " D=3";
+  std::mt19937_64 rng ( seed + 200 );
+  std::uniform_real_distribution<double> coordinate ( 0.0, 1.0 );
+  std::vector<double> points ( 3 * n );
+  for ( auto & x : points ) x = coordinate(rng);
+  double radius = std::cbrt(12.0 / (n * 4.18879));
+  auto distance = [&](Integer u, Integer w){
+    double s = 0.0;
+    for ( Integer i = 0; i < 3; ++ i ) s += (points[3*u+i] - points[3*w+i]) * (points[3*u+i] - points[3*w+i]);
+    return std::sqrt(s);
+  };
+  std::vector<double> levels;
+  Integer N = FlagComplex(n, distance, radius, 3, levels) -> complex() -> size();
+  benchmarks.run("flag complex", ss.str(), N, [&](){
+    return FlagComplex(n, distance, radius, 3, levels) -> complex() -> size();
+  });
+}
+
+int main ( int argc, char * argv [] ) {
+  bool quick = false;
+  Integer repeat = 3;
+  Integer cells = 0;
+  Integer seed = 1;
+  std::string filter;
+  std::string output;
+  for ( int i = 1; i < argc; ++ i ) {
+    std::string arg = argv[i];
+    auto value = [&]() -> std::string {
+      if ( i + 1 >= argc ) throw std::invalid_argument(arg + " requires a value");
+      return argv[++i];
+    };
+    if ( arg == "--quick" ) quick = true;
+    else if ( arg == "--repeat" ) repeat = std::max<Integer>(1, std::stoll(value()));
+    else if ( arg == "--cells" ) cells = std::stoll(value());
+    else if ( arg == "--seed" ) seed = std::stoll(value());
+    else if ( arg == "--threads" ) set_num_threads(std::stoll(value()));
+    else if ( arg == "--filter" ) filter = value();
+    else if ( arg == "--output" ) output = value();
+    else {
+      std::cerr << "usage: " << argv[0] << " [--quick] [--repeat N] [--cells N] [--seed N]"
+                << " [--threads N] [--filter SUBSTRING] [--output FILE]\n";
+      return 1;
+    }
+  }
+  if ( cells == 0 ) cells = quick ? 20000 : 400000;
+  if ( quick ) repeat = std::min<Integer>(repeat, 2);
+
+  Benchmarks benchmarks ( repeat, filter );
+  cubical_benchmarks(benchmarks, cells, seed);
+  cubical_box_benchmarks(benchmarks, cells, seed);
+  cubical_set_benchmarks(benchmarks, cells, seed);
+  simplicial_benchmarks(benchmarks, cells, seed);
+
+  if ( output.empty() ) {
+    benchmarks.json(std::cout, seed, quick);
+  } else {
+    std::ofstream outfile ( output );
+    benchmarks.json(outfile, seed, quick);
+    if ( not outfile ) {
+      std::cerr << "cannot write " << output << "\n";
+      return 1;
+    }
+  }
+  return 0;
+}
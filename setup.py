@@ -43,7 +43,8 @@ class CMakeBuild(build_ext):
         extdir = os.path.abspath(os.path.dirname(self.get_ext_fullpath(ext.name)))
         cmake_args = ['-DCMAKE_LIBRARY_OUTPUT_DIRECTORY=' + extdir,
                       '-DPYTHON_EXECUTABLE=' + sys.executable,
-                      '-DUSER_INCLUDE_PATH=./src/pychomp/_chomp/include']
+                      '-DUSER_INCLUDE_PATH=./src/pychomp/_chomp/include',
+                      '-DCHOMP_BUILD_BENCH=OFF']
 
         cfg = 'Debug' if self.debug else 'Release'
         build_args = ['--config', cfg]
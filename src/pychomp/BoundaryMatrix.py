@@ -0,0 +1,28 @@
+### BoundaryMatrix.py
+### MIT LICENSE 2016 Shaun Harker
+
+import numpy as np
+import scipy.sparse
+
+def BoundaryMatrix(complex, d=None):
+  """
+  Overview:
+    Return the Z_2 boundary matrix of a complex as a scipy.sparse.csc_matrix
+  Inputs:
+    complex : a complex
+    d       : if given, return only the block from dimension d cells
+              to dimension d-1 cells (rows and columns numbered from
+              the first cell of each dimension)
+  Notes:
+    The matrix is assembled in C++ (see Complex.boundary_matrix); for
+    MorseComplex and SimplicialComplex the whole matrix shares its index
+    arrays with the complex.
+  """
+  if d is None:
+    (indptr, indices) = complex.boundary_matrix()
+    shape = (complex.size(), complex.size())
+  else:
+    (indptr, indices) = complex.boundary_matrix(d)
+    shape = (complex.size(d-1), complex.size(d))
+  data = np.ones(len(indices), dtype=np.int8)
+  return scipy.sparse.csc_matrix((data, indices, indptr), shape=shape, copy=False)
@@ -0,0 +1,227 @@
+### SlabConnectionMatrix.py
+### MIT LICENSE 2026 Shaun Harker
+
+import multiprocessing
+import os
+from multiprocessing import shared_memory
+
+import numpy as np
+
+from pychomp._chomp import *
+
+def SlabConnectionMatrix(complex, top_values, slabs=None, processes=None, tile=None):
+  """
+  Overview:
+    Compute ConnectionMatrix of a cubical complex graded by its top cells
+    (as with construct_grading) using several worker processes
+  Inputs:
+    complex    : a CubicalComplex
+    top_values : array of non-negative grades of the top cells, either of
+                 shape complex.boxes() or flat in order of position
+                 (first coordinate fastest)
+    slabs      : number of slabs (defaults to the number of processes)
+    processes  : number of worker processes (defaults to os.cpu_count())
+    tile       : tile size used within each slab (see TiledConnectionMatrix)
+  Algorithm:
+    The top values are placed in POSIX shared memory, which every worker
+    maps. The complex is cut into slabs along its last dimension.
+      1. Each worker finds the critical cells of its slab. The cubical
+         matching of a cell only involves cells with the same coordinates,
+         so slabs need no matching at their interfaces.
+      2. Each worker computes the Morse boundaries of its critical cells.
+         Flows which cross into other slabs read the shared top values.
+    Results come back through shared memory and are glued into one
+    MorseComplex, on which the remaining reductions run in this process.
+    The result is the same as TiledConnectionMatrix(TopCellGrading(...)).
+  Notes:
+    Workers are started with the "spawn" method, so scripts calling this
+    must do so under if __name__ == "__main__":
+    The top values are written straight into the shared block, which is
+    freed on return; the result grades the cells from top_values itself
+    (in place if it is an int64 array, see TopCellGrading).
+    Slabs are not glued: a worker follows flows wherever they lead, so
+    besides the shared values its memory grows with the cells its flows
+    visit, which may be most of the grid.
+  """
+  boxes = list(complex.boxes())
+  periodic = complex.periodic()
+  D = len(boxes)
+  L = int(np.prod(boxes))
+  top_values = np.asarray(top_values)
+  if top_values.shape not in (tuple(boxes), (L,)):
+    raise ValueError("SlabConnectionMatrix: need one value per top cell")
+  if processes is None:
+    processes = os.cpu_count() or 1
+  tile = list(tile or [])
+  extent = boxes[-1] + (0 if periodic else 1)
+  slabs = max(1, min(slabs or processes, extent))
+  bounds = [ (extent * k) // slabs for k in range(slabs + 1) ]
+  lo = [ [0] * (D-1) + [bounds[k]] for k in range(slabs) ]
+  hi = [ [ b + (0 if periodic else 1) for b in boxes[:-1] ] + [bounds[k+1]] for k in range(slabs) ]
+
+  shared = []
+  given = []
+  try:
+    top = _share(top_values, shared)
+    context = multiprocessing.get_context("spawn")
+    with context.Pool(processes, initializer=_worker_initializer) as pool:
+      # 1. Critical cells of each slab
+      found = _map(pool, _slab_critical_cells,
+                   [ (boxes, periodic, top, lo[k], hi[k], tile) for k in range(slabs) ], given)
+      slab_cells = [ _take(cells) for (cells, grades) in found ]
+      slab_grades = [ _take(grades) for (cells, grades) in found ]
+      cells = np.concatenate(slab_cells)
+      grades = np.concatenate(slab_grades)
+      order = np.argsort(cells, kind='stable')
+      cells = cells[order]
+      grades = grades[order]
+
+      # 2. Morse boundaries of the critical cells of each slab
+      critical = _share(cells, shared)
+      boundaries = _map(pool, _slab_morse_boundaries,
+                        [ (boxes, periodic, top, critical, _share(slab_cells[k], shared))
+                          for k in range(slabs) ], given)
+
+    # Glue the slab boundaries together in the order of the critical cells
+    N = cells.size
+    lengths = np.zeros(N, dtype=np.int64)
+    pieces = []
+    for k in range(slabs):
+      offsets = _take(boundaries[k][0])
+      entries = _take(boundaries[k][1])
+      ranks = np.searchsorted(cells, slab_cells[k])
+      lengths[ranks] = np.diff(offsets)
+      pieces.append((ranks, offsets, entries))
+    offsets = np.zeros(N + 1, dtype=np.int64)
+    np.cumsum(lengths, out=offsets[1:])
+    entries = np.empty(offsets[-1], dtype=np.int64)
+    for (ranks, slab_offsets, slab_entries) in pieces:
+      slab_lengths = np.diff(slab_offsets)
+      start = np.repeat(offsets[ranks] - slab_offsets[:-1], slab_lengths)
+      entries[start + np.arange(slab_entries.size)] = slab_entries
+  finally:
+    for block in shared:
+      block.close()
+      block.unlink()
+    # blocks of workers which are not taken yet, e.g. if a worker failed
+    for handle in given:
+      _discard(handle)
+
+  grading = TopCellGrading(complex, top_values)
+  base = grading.graded_complex()
+  reduced = CriticalMorseGradedComplex(grading, cells, grades, offsets, entries)
+  while reduced.complex().size() != base.complex().size():
+    base = reduced
+    reduced = MorseGradedComplex(base)
+  return base
+
+# Worker data is passed around as (shared memory name, length) pairs of
+# int64 arrays. Blocks created by the parent are unlinked by the parent;
+# blocks created by workers are unlinked by the parent once read (_take),
+# or when the computation fails (_discard).
+
+def _share(array, shared):
+  """
+  Copy an array into a new int64 shared memory block owned by this
+  process, raveled first coordinate fastest (without a temporary copy)
+  """
+  block = shared_memory.SharedMemory(create=True, size=max(1, 8 * array.size))
+  shared.append(block)
+  view = np.ndarray((array.size,), dtype=np.int64, buffer=block.buf)
+  view.reshape(array.shape, order='F')[...] = array
+  return (block.name, array.size)
+
+def _give(array):
+  """
+  Copy an int64 array into a new shared memory block for the parent to _take
+  """
+  block = shared_memory.SharedMemory(create=True, size=max(1, array.nbytes))
+  np.ndarray(array.shape, dtype=np.int64, buffer=block.buf)[:] = array
+  name = block.name
+  block.close()
+  return (name, array.size)
+
+def _take(handle):
+  """
+  Copy out and unlink a block made by _give
+  """
+  (name, size) = handle
+  block = shared_memory.SharedMemory(name=name)
+  try:
+    return np.ndarray((size,), dtype=np.int64, buffer=block.buf).copy()
+  finally:
+    block.close()
+    block.unlink()
+
+def _discard(handle):
+  """
+  Unlink a block made by _give, unless it has been taken already
+  """
+  try:
+    block = shared_memory.SharedMemory(name=handle[0])
+  except FileNotFoundError:
+    return
+  block.close()
+  block.unlink()
+
+def _map(pool, function, tasks, given):
+  """
+  pool.map(function, tasks) for functions returning tuples of _give
+  handles. Waits for every task and records the handles of those which
+  succeed in given, so they can be discarded if another task fails.
+  """
+  results = [None] * len(tasks)
+  error = None
+  iterator = pool.imap_unordered(_indexed, [ (function, k, task) for (k, task) in enumerate(tasks) ])
+  while True:
+    try:
+      (k, result) = next(iterator)
+    except StopIteration:
+      break
+    except Exception as e:
+      error = error or e
+      continue
+    results[k] = result
+    given.extend(result)
+  if error is not None:
+    raise error
+  return results
+
+def _indexed(arguments):
+  (function, k, task) = arguments
+  return (k, function(task))
+
+def _attach(handle):
+  """
+  Map a block made by _share; returns (block, array viewing it)
+  """
+  (name, size) = handle
+  block = shared_memory.SharedMemory(name=name)
+  return (block, np.ndarray((size,), dtype=np.int64, buffer=block.buf))
+
+def _worker_initializer():
+  # one thread per worker process; the processes provide the parallelism
+  set_num_threads(1)
+
+def _slab_grading(boxes, periodic, top):
+  (block, values) = _attach(top)
+  return (block, TopCellGrading(CubicalComplex(boxes, periodic), values))
+
+def _slab_critical_cells(arguments):
+  (boxes, periodic, top, lo, hi, tile) = arguments
+  (block, grading) = _slab_grading(boxes, periodic, top)
+  (cells, grades) = box_critical_cells(grading, lo, hi, tile)
+  del grading
+  block.close()
+  return (_give(cells), _give(grades))
+
+def _slab_morse_boundaries(arguments):
+  (boxes, periodic, top, critical, slab) = arguments
+  (block, grading) = _slab_grading(boxes, periodic, top)
+  (critical_block, critical_cells) = _attach(critical)
+  (slab_block, slab_cells) = _attach(slab)
+  (offsets, entries) = morse_boundaries(grading, critical_cells, slab_cells)
+  del grading, critical_cells, slab_cells
+  for b in (block, critical_block, slab_block):
+    b.close()
+  return (_give(offsets), _give(entries))
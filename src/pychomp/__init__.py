@@ -13,5 +13,7 @@ from pychomp.TransitiveClosure import *
 from pychomp.Poset import *
 from pychomp.StronglyConnectedComponents import *
 from pychomp.DrawGradedComplex import *
+from pychomp.BoundaryMatrix import *
 
 
+from pychomp.SlabConnectionMatrix import *
@@ -4,41 +4,73 @@
 /// MIT LICENSE
 
 #include "Integer.h"
+#include "IndexArray.h"
+#include "Parallel.h"
+#include "DenseZ2.h"
+#include "Progress.h"
+#include "Instrumentation.h"
 #include "Iterator.h"
 #include "Chain.h"
+#include "CompressedChains.h"
 #include "Complex.h"
 #include "CubicalComplex.h"
+#include "CubicalSetComplex.h"
 #include "MorseComplex.h"
 #include "MorseMatching.h"
 #include "MorseMatching.hpp"
 #include "CubicalMorseMatching.h"
 #include "GenericMorseMatching.h"
 #include "Homology.h"
+#include "Components.h"
+#include "IntegralHomology.h"
 #include "GradedComplex.h"
 #include "MorseGradedComplex.h"
 #include "ConnectionMatrix.h"
+#include "TiledConnectionMatrix.h"
+#include "BatchConnectionMatrix.h"
+#include "StreamingConnectionMatrix.h"
 #include "Grading.h"
+#include "ImageComplex.h"
+#include "FlowGraph.h"
 #include "SimplicialComplex.h"
 #include "OrderComplex.h"
+#include "FlagComplex.h"
 #include "DualComplex.h"
+#include "ResultCache.h"
+#include "Serialization.h"
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 namespace py = pybind11;
 
 PYBIND11_MODULE( _chomp, m) {
+  ParallelBinding(m);
+  DenseZ2Binding(m);
+  ProgressBinding(m);
+  InstrumentationBinding(m);
   ComplexBinding(m);
   CubicalComplexBinding(m);
+  CubicalSetComplexBinding(m);
   MorseMatchingBinding(m);
   CubicalMorseMatchingBinding(m);
   GenericMorseMatchingBinding(m);
   MorseComplexBinding(m);
   HomologyBinding(m);
+  ComponentsBinding(m);
+  IntegralHomologyBinding(m);
   GradedComplexBinding(m);
   MorseGradedComplexBinding(m);
   ConnectionMatrixBinding(m);
+  TiledConnectionMatrixBinding(m);
+  BatchConnectionMatrixBinding(m);
+  StreamingConnectionMatrixBinding(m);
   GradingBinding(m);
+  ImageComplexBinding(m);
+  FlowGraphBinding(m);
   SimplicialComplexBinding(m);
   OrderComplexBinding(m);
+  FlagComplexBinding(m);
   DualComplexBinding(m);
+  ResultCacheBinding(m);
+  SerializationBinding(m);
 }
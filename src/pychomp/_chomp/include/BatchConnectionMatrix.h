@@ -0,0 +1,193 @@
+/// BatchConnectionMatrix.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <atomic>
+#include <stdexcept>
+
+#include "Integer.h"
+#include "Chain.h"
+#include "CompressedChains.h"
+#include "CubicalComplex.h"
+#include "GradedComplex.h"
+#include "MorseComplex.h"
+#include "ConnectionMatrix.h"
+#include "TiledConnectionMatrix.h"
+#include "Parallel.h"
+#include "Progress.h"
+#include "Instrumentation.h"
+
+/// CompactConnectionMatrix
+///   A connection matrix with nothing attached: for each generator, the
+///   cell of the original complex it comes from and its grade, and the
+///   boundary matrix in terms of generators. Generators are numbered by
+///   dimension, those of dimension d being begin()[d], ..., begin()[d+1]-1.
+class CompactConnectionMatrix {
+public:
+  /// CompactConnectionMatrix
+  ///   Extract from the result of ConnectionMatrix
+  CompactConnectionMatrix ( std::shared_ptr<GradedComplex> connection_matrix ) {
+    auto complex = connection_matrix -> complex();
+    Integer N = complex -> size();
+    Integer D = complex -> dimension();
+    begin_.resize(D + 2);
+    for ( Integer d = 0; d <= D; ++ d ) begin_[d] = *(*complex)(d).begin();
+    begin_[D+1] = N;
+    values_.resize(N);
+    cells_.resize(N);
+    std::vector<Chain> bd ( N );
+    for ( auto x : *complex ) {
+      values_[x] = connection_matrix -> value(x);
+      bd[x] = complex -> boundary({x});
+      // follow the generator down the tower of Morse complexes
+      Integer cell = x;
+      for ( auto morse = std::dynamic_pointer_cast<MorseComplex>(complex); morse;
+            morse = std::dynamic_pointer_cast<MorseComplex>(morse -> base()) ) {
+        cell = *morse -> include({cell}).begin();
+      }
+      cells_[x] = cell;
+    }
+    boundary_ = CompressedChains(bd);
+  }
+
+  /// size
+  ///   Number of generators
+  Integer
+  size ( void ) const {
+    return cells_.size();
+  }
+
+  /// begin
+  std::vector<Integer> const&
+  begin ( void ) const {
+    return begin_;
+  }
+
+  /// cells
+  std::vector<Integer> const&
+  cells ( void ) const {
+    return cells_;
+  }
+
+  /// values
+  std::vector<Integer> const&
+  values ( void ) const {
+    return values_;
+  }
+
+  /// boundary
+  ///   Boundary of generator i (generators, in increasing order)
+  std::vector<Integer>
+  boundary ( Integer i ) const {
+    std::vector<Integer> result;
+    boundary_.for_each(i, [&](Integer y){ result.push_back(y); });
+    return result;
+  }
+
+  /// count
+  ///   Number of generators of each dimension, by grade
+  std::unordered_map<Integer,std::vector<Integer>>
+  count ( void ) const {
+    std::unordered_map<Integer,std::vector<Integer>> result;
+    Integer D = begin_.size() - 2;
+    for ( Integer d = 0; d <= D; ++ d ) {
+      for ( Integer i = begin_[d]; i < begin_[d+1]; ++ i ) {
+        auto & counts = result[values_[i]];
+        if ( counts.empty() ) counts.resize(D + 1);
+        counts[d] += 1;
+      }
+    }
+    return result;
+  }
+
+  /// memory
+  Integer
+  memory ( void ) const {
+    return sizeof(Integer) * (begin_.size() + cells_.size() + values_.size()) + boundary_.memory();
+  }
+
+private:
+  std::vector<Integer> begin_;
+  std::vector<Integer> cells_;
+  std::vector<Integer> values_;
+  CompressedChains boundary_;
+};
+
+/// BatchConnectionMatrix
+///   Connection matrices of K gradings of one cubical complex, given by
+///   their top cell values: grading k has its T = complex -> size(D) top
+///   cell values at values[k*T], ..., values[(k+1)*T - 1] (in the order of
+///   TopCellGrading). Each result is the same as ConnectionMatrix of the
+///   complex graded by the minimum over each cell's top star.
+///   The complex (and so its shape and offset tables) is shared by all of
+///   the computations, which are spread over num_threads() threads; with
+///   fewer gradings than threads each computation gets several threads.
+///   Only the compact results are kept.
+inline std::vector<std::shared_ptr<CompactConnectionMatrix>>
+BatchConnectionMatrix ( std::shared_ptr<CubicalComplex> complex,
+                        Integer const* values,
+                        Integer K ) {
+  StageTimer timer ( "batch connection matrix" );
+  Integer N = complex -> size();
+  Integer T = complex -> size(complex -> dimension());
+  std::vector<std::shared_ptr<CompactConnectionMatrix>> result ( K );
+  Integer workers = std::max<Integer>(1, std::min(num_threads(), K));
+  Integer threads = std::max<Integer>(1, num_threads() / workers);
+  // each worker takes the next grading as it goes, and polls the caller's
+  // progress monitor (installed by parallel_for_blocks) after each one
+  std::atomic<Integer> next ( 0 ), done ( 0 );
+  parallel_for_blocks(0, workers, [&](Integer, Integer){
+    ThreadBudget budget ( threads );
+    for ( Integer k = next ++; k < K; k = next ++ ) {
+      TopCellGrading top ( complex, values + k * T, nullptr );
+      std::vector<Integer> grades ( N );
+      parallel_for(0, N, [&](Integer x){ grades[x] = top.value(x); });
+      auto graded_complex = std::make_shared<GradedComplex>(complex, std::move(grades));
+      result[k] = std::make_shared<CompactConnectionMatrix>(ConnectionMatrix(graded_complex));
+      poll_progress("batch connection matrix", ++ done, K);
+    }
+  }, 1);
+  return result;
+}
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+namespace py = pybind11;
+
+inline void
+BatchConnectionMatrixBinding(py::module &m) {
+  py::class_<CompactConnectionMatrix, std::shared_ptr<CompactConnectionMatrix>>(m, "CompactConnectionMatrix")
+    .def(py::init<std::shared_ptr<GradedComplex>>())
+    .def("size", &CompactConnectionMatrix::size)
+    .def("__len__", &CompactConnectionMatrix::size)
+    .def("begin", &CompactConnectionMatrix::begin)
+    .def("cells", &CompactConnectionMatrix::cells)
+    .def("values", &CompactConnectionMatrix::values)
+    .def("boundary", &CompactConnectionMatrix::boundary)
+    .def("count", &CompactConnectionMatrix::count)
+    .def("memory", &CompactConnectionMatrix::memory);
+  m.def("BatchConnectionMatrix", [](std::shared_ptr<CubicalComplex> complex,
+                                    py::array_t<Integer, py::array::c_style | py::array::forcecast> values,
+                                    py::object progress, std::shared_ptr<CancellationToken> token, double interval) {
+    // values : K x T array, one row of top cell values per grading
+    // (each row ordered with the first coordinate fastest)
+    Integer T = complex -> size(complex -> dimension());
+    if ( values.ndim() != 2 || values.shape(1) != T ) {
+      throw std::invalid_argument("BatchConnectionMatrix: need a K x (number of top cells) array");
+    }
+    Integer K = values.shape(0);
+    Integer const* data = values.data();
+    return with_progress(progress, token, interval, [&](){
+      return BatchConnectionMatrix(complex, data, K);
+    });
+  }, py::arg("complex"), py::arg("values"), py::arg("progress") = py::none(),
+     py::arg("token") = py::none(), py::arg("interval") = 0.1);
+}
@@ -7,9 +7,13 @@
 
 #include "common.h"
 
+#include <stdexcept>
+
 #include "Integer.h"
 #include "Iterator.h"
 #include "Chain.h"
+#include "CompressedChains.h"
+#include "Parallel.h"
 
 /// Complex
 class Complex {
@@ -96,7 +100,90 @@ public:
   ///   boundary matrix
   virtual void
   row ( Integer i, std::function<void(Integer)> const& callback) const {};
+
+  /// signed_column
+  ///   Apply "callback" to (face, coefficient) for the ith column of the
+  ///   boundary matrix with integer coefficients (entries for the same
+  ///   face are to be added). Only complexes with oriented cells
+  ///   (cubical and simplicial complexes) define it.
+  virtual void
+  signed_column ( Integer, std::function<void(Integer,Integer)> const& ) const {
+    throw std::logic_error("Complex: no integer boundary for this kind of complex");
+  }
   
+  /// compressed_boundary
+  ///   Complexes which store their boundary matrix in compressed form
+  ///   return it here (so it can be exported without copying);
+  ///   others return nullptr.
+  virtual CompressedChains const*
+  compressed_boundary ( void ) const {
+    return nullptr;
+  }
+
+  /// boundary_matrix
+  ///   Fill indptr and indices with the Z_2 boundary matrix in compressed
+  ///   sparse column (CSC) form, with the entries of each column sorted.
+  ///   If d is negative the whole matrix is produced, with rows and columns
+  ///   indexed by cell. Otherwise only the block from dimension d cells to
+  ///   dimension d-1 cells is produced, with rows and columns numbered from
+  ///   the first cell of dimension d-1 and d respectively.
+  ///   Columns are filled in parallel from column().
+  void
+  boundary_matrix ( Integer d,
+                    std::vector<Integer> & indptr,
+                    std::vector<Integer> & indices ) const {
+    Integer col_begin = 0, col_end = size(), row_begin = 0;
+    if ( d >= 0 ) {
+      col_begin = (d <= dimension()) ? *begin_[d] : size();
+      col_end = col_begin + size(d);
+      row_begin = (d > 0 && d <= dimension() + 1) ? *begin_[d-1] : 0;
+    }
+    Integer N = col_end - col_begin;
+    indptr.assign(N+1, 0);
+    // Fast path: boundary already stored in compressed form
+    if ( auto bd = compressed_boundary() ) {
+      auto const& offsets = bd -> offsets();
+      auto const& entries = bd -> entries();
+      Integer base = offsets[col_begin];
+      parallel_for(0, N+1, [&](Integer j){ indptr[j] = offsets[col_begin + j] - base; });
+      indices.resize(indptr[N]);
+      parallel_for(0, indptr[N], [&](Integer k){ indices[k] = entries[base + k] - row_begin; });
+      return;
+    }
+    // Count column sizes
+    std::vector<Integer> count ( N );
+    parallel_for(0, N, [&](Integer j){
+      Integer c = 0;
+      column(col_begin + j, [&](Integer){ ++ c; });
+      count[j] = c;
+    });
+    std::vector<Integer> raw_offsets ( count );
+    Integer raw_nnz = parallel_exclusive_scan ( raw_offsets );
+    // Fill columns, then sort and cancel repeated entries (Z_2 coefficients)
+    std::vector<Integer> raw ( raw_nnz );
+    parallel_for(0, N, [&](Integer j){
+      Integer * first = raw.data() + raw_offsets[j];
+      Integer * p = first;
+      column(col_begin + j, [&](Integer x){ *p++ = x - row_begin; });
+      std::sort(first, p);
+      Integer * q = first;
+      for ( Integer * r = first; r != p; ) {
+        if ( r + 1 != p && r[0] == r[1] ) { r += 2; continue; }
+        *q++ = *r++;
+      }
+      count[j] = q - first;
+    });
+    // Compact
+    std::copy(count.begin(), count.end(), indptr.begin());
+    indptr[N] = 0;
+    Integer nnz = parallel_exclusive_scan ( indptr );
+    indices.resize(nnz);
+    parallel_for(0, N, [&](Integer j){
+      std::copy(raw.begin() + raw_offsets[j], raw.begin() + raw_offsets[j] + count[j],
+                indices.begin() + indptr[j]);
+    });
+  }
+
   /// dimension
   Integer 
   dimension ( void ) const {
@@ -152,8 +239,44 @@ protected:
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 namespace py = pybind11;
 
+/// IntegerArray
+///   C-contiguous NumPy array of Integer, used by the bulk accessors.
+///   Inputs of other integer dtypes are converted on the way in.
+typedef py::array_t<Integer, py::array::c_style | py::array::forcecast> IntegerArray;
+
+/// as_array
+///   Hand a vector over to a NumPy array without copying it
+inline IntegerArray
+as_array ( std::vector<Integer> && v ) {
+  auto p = new std::vector<Integer>(std::move(v));
+  py::capsule owner ( p, [](void * q) { delete reinterpret_cast<std::vector<Integer>*>(q); });
+  return IntegerArray(p->size(), p->data(), owner);
+}
+
+/// as_readonly_array
+///   Read-only NumPy view of a vector owned by the Python object "owner",
+///   which the view keeps alive
+inline IntegerArray
+as_readonly_array ( std::vector<Integer> const& v, py::handle owner ) {
+  IntegerArray result ( v.size(), v.data(), owner );
+  result.attr("setflags")(py::arg("write") = false);
+  return result;
+}
+
+/// as_readonly_array
+///   Read-only NumPy view of an IndexArray owned by the Python object
+///   "owner" (int32 or int64, following its storage)
+inline py::array
+as_readonly_array ( IndexArray const& v, py::handle owner ) {
+  if ( v.wide() ) return as_readonly_array(v.wide_data(), owner);
+  py::array_t<int32_t> result ( v.size(), v.narrow_data().data(), owner );
+  result.attr("setflags")(py::arg("write") = false);
+  return result;
+}
+
 inline void
 ComplexBinding(py::module &m) {
   py::class_<Complex, std::shared_ptr<Complex>>(m, "Complex")
@@ -174,5 +297,34 @@ ComplexBinding(py::module &m) {
     .def("__len__", (Integer(Complex::*)(void)const)&Complex::size)
     .def("size", (Integer(Complex::*)(void)const)&Complex::size)
     .def("size", (Integer(Complex::*)(Integer)const)&Complex::size)
-    .def("count", &Complex::count);
+    .def("count", &Complex::count)
+    .def("boundary_matrix", [](py::object self, Integer d) {
+       // Returns (indptr, indices) of the boundary matrix in CSC form.
+       // For complexes which store their boundary compressed, the whole
+       // matrix is returned as read-only views of that storage (int32
+       // arrays when it is stored compactly, see IndexArray.h).
+       Complex const& complex = self.cast<Complex const&>();
+       if ( d < 0 && complex.compressed_boundary() ) {
+         auto bd = complex.compressed_boundary();
+         return py::make_tuple(as_readonly_array(bd -> offsets(), self),
+                               as_readonly_array(bd -> entries(), self));
+       }
+       std::vector<Integer> indptr, indices;
+       {
+         py::gil_scoped_release release;
+         complex.boundary_matrix(d, indptr, indices);
+       }
+       return py::make_tuple(as_array(std::move(indptr)), as_array(std::move(indices)));
+    }, py::arg("d") = -1)
+    .def("cells_of_dimension", [](Complex const& v, Integer d) {
+       Integer n = v.size(d);
+       Integer b = (n > 0) ? *v(d).begin() : 0;
+       IntegerArray result(n);
+       Integer * out = result.mutable_data();
+       {
+         py::gil_scoped_release release;
+         std::iota(out, out + n, b);
+       }
+       return result;
+    });
 }
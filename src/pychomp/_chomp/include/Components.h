@@ -0,0 +1,217 @@
+/// Components.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+
+#include "Integer.h"
+#include "Complex.h"
+#include "GradedComplex.h"
+#include "Parallel.h"
+#include "Instrumentation.h"
+
+/// UnionFind
+///   Disjoint sets of 0, ..., n-1 which may be merged concurrently. Each
+///   set is a tree whose root is its least element: finds split paths as
+///   they go, and unite links the greater root below the lesser with a
+///   compare-and-swap, retrying if that root has been linked meanwhile.
+class UnionFind {
+public:
+  /// UnionFind
+  UnionFind ( Integer n ) : parent_(n) {
+    parallel_for(0, n, [&](Integer x){ parent_[x].store(x, std::memory_order_relaxed); });
+  }
+
+  /// size
+  Integer
+  size ( void ) const {
+    return parent_.size();
+  }
+
+  /// find
+  ///   The least element of the set of x
+  Integer
+  find ( Integer x ) {
+    while ( true ) {
+      Integer p = parent_[x].load(std::memory_order_relaxed);
+      if ( p == x ) return x;
+      Integer g = parent_[p].load(std::memory_order_relaxed);
+      if ( g != p ) parent_[x].compare_exchange_weak(p, g, std::memory_order_relaxed);
+      x = p;
+    }
+  }
+
+  /// unite
+  ///   Merge the sets of x and y; return false if they were the same
+  bool
+  unite ( Integer x, Integer y ) {
+    while ( true ) {
+      x = find(x);
+      y = find(y);
+      if ( x == y ) return false;
+      if ( x < y ) std::swap(x, y);
+      Integer expected = x;
+      if ( parent_[x].compare_exchange_strong(expected, y, std::memory_order_relaxed) ) return true;
+    }
+  }
+
+private:
+  std::vector<std::atomic<Integer>> parent_;
+};
+
+/// vertex_of_
+///   A vertex in the closure of a cell (following first faces down)
+inline Integer
+vertex_of_ ( Complex const& complex, Integer cell, Integer d ) {
+  for ( ; d > 0; -- d ) {
+    Integer face = -1;
+    complex.column(cell, [&](Integer x){ if ( face == -1 ) face = x; });
+    if ( face == -1 ) throw std::invalid_argument("ConnectedComponents: cell without faces");
+    cell = face;
+  }
+  return cell;
+}
+
+/// ConnectedComponents
+///   Label the cells of dimension d (by default the top dimension) of a
+///   complex by the connected component they lie in, and return the
+///   number of components. Components are numbered in order of their
+///   least vertex. The vertices are merged across the edges in parallel,
+///   so this takes near-linear time in the vertices and edges, without
+///   the Morse reductions of Homology.
+inline Integer
+ConnectedComponents ( Complex const& complex, std::vector<Integer> & labels, Integer d = -1 ) {
+  StageTimer timer ( "components" );
+  if ( d < 0 ) d = complex.dimension();
+  if ( d > complex.dimension() ) throw std::invalid_argument("ConnectedComponents: no cells of that dimension");
+  Integer vertex_begin = *complex(0).begin();
+  Integer V = complex.size(0);
+  UnionFind sets ( V );
+  if ( complex.dimension() > 0 ) {
+    Integer edge_begin = *complex(1).begin();
+    parallel_for(0, complex.size(1), [&](Integer e){
+      Integer u = -1;
+      complex.column(edge_begin + e, [&](Integer v){
+        if ( u == -1 ) u = v; else sets.unite(u - vertex_begin, v - vertex_begin);
+      });
+    });
+  }
+  // number the roots in order
+  std::vector<Integer> number ( V + 1, 0 );
+  parallel_for(0, V, [&](Integer v){ number[v] = ( sets.find(v) == v ) ? 1 : 0; });
+  Integer count = parallel_exclusive_scan(number);
+  Integer N = complex.size(d);
+  Integer cell_begin = N > 0 ? *complex(d).begin() : 0;
+  labels.assign(N, 0);
+  parallel_for(0, N, [&](Integer i){
+    labels[i] = number[sets.find(vertex_of_(complex, cell_begin + i, d) - vertex_begin)];
+  });
+  Instrumentation::instance().add("components", count);
+  return count;
+}
+
+/// ZeroDimensionalPersistence
+///   The 0-dimensional persistence of the sublevel set filtration of a
+///   graded complex: on return pairs holds (birth, death) for each
+///   component which is born and later dies (merges with an older one),
+///   flattened, and essential holds the birth of each component which
+///   never dies, in increasing order. Pairs of zero length are omitted.
+///   An edge enters at its value, or at that of a later vertex of it.
+///   The edges are sorted by entry (in parallel) and swept once through
+///   a union-find whose roots are the oldest vertex of their set.
+inline void
+ZeroDimensionalPersistence ( GradedComplex const& graded_complex,
+                             std::vector<Integer> & pairs,
+                             std::vector<Integer> & essential ) {
+  StageTimer timer ( "persistence" );
+  Complex const& complex = *graded_complex.complex();
+  Integer vertex_begin = *complex(0).begin();
+  Integer V = complex.size(0);
+  Integer E = complex.dimension() > 0 ? complex.size(1) : 0;
+  Integer edge_begin = E > 0 ? *complex(1).begin() : 0;
+  std::vector<Integer> birth ( V );
+  parallel_for(0, V, [&](Integer v){ birth[v] = graded_complex.value(vertex_begin + v); });
+  // edges (entry, u, v), in order of entry
+  struct Edge { Integer entry, u, v; };
+  std::vector<Edge> edges ( E );
+  parallel_for(0, E, [&](Integer e){
+    Edge & edge = edges[e];
+    edge.entry = graded_complex.value(edge_begin + e);
+    edge.u = edge.v = -1;
+    complex.column(edge_begin + e, [&](Integer x){
+      x -= vertex_begin;
+      if ( edge.u == -1 ) edge.u = x; else edge.v = x;
+      edge.entry = std::max(edge.entry, birth[x]);
+    });
+  });
+  parallel_sort(edges.begin(), edges.end(), [](Edge const& a, Edge const& b){
+    return a.entry < b.entry || ( a.entry == b.entry && a.u < b.u ) ||
+           ( a.entry == b.entry && a.u == b.u && a.v < b.v );
+  });
+  // elder rule: the younger root (later birth, then greater index) dies
+  auto older = [&](Integer x, Integer y){
+    return birth[x] < birth[y] || ( birth[x] == birth[y] && x < y );
+  };
+  std::vector<Integer> parent ( V );
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&](Integer x){
+    while ( parent[x] != x ) x = parent[x] = parent[parent[x]];
+    return x;
+  };
+  pairs.clear();
+  for ( auto const& edge : edges ) {
+    if ( edge.v == -1 ) continue;
+    Integer x = find(edge.u), y = find(edge.v);
+    if ( x == y ) continue;
+    if ( older(x, y) ) std::swap(x, y);
+    parent[x] = y;
+    if ( edge.entry > birth[x] ) {
+      pairs.push_back(birth[x]);
+      pairs.push_back(edge.entry);
+    }
+  }
+  essential.clear();
+  for ( Integer v = 0; v < V; ++ v ) if ( parent[v] == v ) essential.push_back(birth[v]);
+  std::sort(essential.begin(), essential.end());
+  Instrumentation::instance().add("persistence pairs", (Integer) pairs.size() / 2);
+}
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+namespace py = pybind11;
+
+inline void
+ComponentsBinding(py::module &m) {
+  m.def("ConnectedComponents", [](std::shared_ptr<Complex> complex, Integer d) {
+    // Returns (count, labels): the number of connected components, and the
+    // component of each cell of dimension d (by default the top dimension)
+    std::vector<Integer> labels;
+    Integer count;
+    {
+      py::gil_scoped_release release;
+      count = ConnectedComponents(*complex, labels, d);
+    }
+    return py::make_tuple(count, as_array(std::move(labels)));
+  }, py::arg("complex"), py::arg("dimension") = -1);
+  m.def("ZeroDimensionalPersistence", [](std::shared_ptr<GradedComplex> graded_complex) {
+    // Returns (pairs, essential): an n x 2 array of (birth, death) grades
+    // and the births of the components which never die
+    std::vector<Integer> pairs, essential;
+    {
+      py::gil_scoped_release release;
+      ZeroDimensionalPersistence(*graded_complex, pairs, essential);
+    }
+    return py::make_tuple(as_array(std::move(pairs)).attr("reshape")(-1, 2),
+                          as_array(std::move(essential)));
+  });
+}
@@ -0,0 +1,153 @@
+/// CompressedChains.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include "Integer.h"
+#include "IndexArray.h"
+#include "Chain.h"
+#include "Parallel.h"
+
+/// CompressedChains
+///   An array of Z_2 chains stored in compressed sparse column form:
+///   the entries of chain i are entries()[offsets()[i]], ...,
+///   entries()[offsets()[i+1]-1], in increasing order.
+///   Used as boundary/coboundary storage for complexes which keep their
+///   boundary matrix explicitly; the arrays can be handed to NumPy as-is.
+///   Offsets and entries are IndexArrays, so they take 32 bits each
+///   unless the chains are too large.
+class CompressedChains {
+public:
+  /// CompressedChains
+  ///   Default constructor (no chains)
+  CompressedChains ( void ) : offsets_(1, 0) {}
+
+  /// CompressedChains
+  ///   Compress an array of chains
+  CompressedChains ( std::vector<Chain> const& chains ) {
+    Integer N = chains.size();
+    std::vector<Integer> offsets ( N+1 );
+    std::vector<Integer> largest ( N, 0 );
+    offsets[0] = 0;
+    for ( Integer i = 0; i < N; ++ i ) offsets[i+1] = offsets[i] + chains[i].size();
+    parallel_for(0, N, [&](Integer i){
+      for ( auto x : chains[i] ) largest[i] = std::max(largest[i], x);
+    });
+    Integer bound = largest.empty() ? 0 : *std::max_element(largest.begin(), largest.end());
+    entries_.assign(offsets[N], 0, bound);
+    parallel_for_blocks(0, N, [&](Integer b, Integer e){
+      std::vector<Integer> sorted;
+      for ( Integer i = b; i < e; ++ i ) {
+        sorted.assign(chains[i].begin(), chains[i].end());
+        std::sort(sorted.begin(), sorted.end());
+        for ( Integer k = 0; k < (Integer) sorted.size(); ++ k ) entries_.set(offsets[i] + k, sorted[k]);
+      }
+    });
+    offsets_ = IndexArray(std::move(offsets));
+  }
+
+  /// CompressedChains
+  ///   Adopt offset and entry arrays. Entries of each chain must be sorted.
+  CompressedChains ( std::vector<Integer> && offsets,
+                     std::vector<Integer> && entries )
+                   : offsets_(std::move(offsets)), entries_(std::move(entries)) {}
+
+  /// CompressedChains
+  ///   Adopt offset and entry arrays. Entries of each chain must be sorted.
+  CompressedChains ( IndexArray && offsets,
+                     IndexArray && entries )
+                   : offsets_(std::move(offsets)), entries_(std::move(entries)) {}
+
+  /// size
+  ///   Number of chains
+  Integer
+  size ( void ) const {
+    return offsets_.size() - 1;
+  }
+
+  /// nnz
+  ///   Total number of entries
+  Integer
+  nnz ( void ) const {
+    return entries_.size();
+  }
+
+  /// for_each
+  ///   Call f on each entry of chain i
+  template < typename F >
+  void
+  for_each ( Integer i, F const& f ) const {
+    entries_.for_range(offsets_[i], offsets_[i+1], f);
+  }
+
+  /// chain
+  ///   Return chain i as a Chain
+  Chain
+  chain ( Integer i ) const {
+    Chain result;
+    for_each(i, [&](Integer x){ result += x; });
+    return result;
+  }
+
+  /// offsets
+  IndexArray const&
+  offsets ( void ) const {
+    return offsets_;
+  }
+
+  /// entries
+  IndexArray const&
+  entries ( void ) const {
+    return entries_;
+  }
+
+  /// transpose
+  ///   Return the transposed matrix, which has num_rows chains.
+  ///   Counting sort, so the entries of the result come out sorted.
+  ///   Large matrices are counted and filled in parallel with atomic
+  ///   cursors, then each chain of the result is sorted.
+  CompressedChains
+  transpose ( Integer num_rows ) const {
+    Integer N = size();
+    if ( num_threads() > 1 && nnz() >= 65536 ) {
+      std::vector<std::atomic<Integer>> cursor ( num_rows );
+      parallel_for_blocks(0, nnz(), [&](Integer b, Integer e){
+        entries_.for_range(b, e, [&](Integer x){ cursor[x].fetch_add(1, std::memory_order_relaxed); });
+      });
+      std::vector<Integer> offsets ( num_rows + 1, 0 );
+      parallel_for(0, num_rows, [&](Integer x){ offsets[x] = cursor[x].load(std::memory_order_relaxed); });
+      parallel_exclusive_scan(offsets);
+      parallel_for(0, num_rows, [&](Integer x){ cursor[x].store(offsets[x], std::memory_order_relaxed); });
+      IndexArray entries ( nnz(), 0, N );
+      parallel_for(0, N, [&](Integer i){
+        for_each(i, [&](Integer x){ entries.set(cursor[x].fetch_add(1, std::memory_order_relaxed), i); });
+      });
+      parallel_for(0, num_rows, [&](Integer x){ entries.sort(offsets[x], offsets[x+1]); });
+      return CompressedChains(IndexArray(std::move(offsets)), std::move(entries));
+    }
+    std::vector<Integer> offsets ( num_rows + 1, 0 );
+    entries_.for_range(0, nnz(), [&](Integer x){ ++ offsets[x+1]; });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    IndexArray entries ( nnz(), 0, N );
+    std::vector<Integer> fill ( offsets.begin(), offsets.end() - 1 );
+    for ( Integer i = 0; i < N; ++ i ) {
+      for_each(i, [&](Integer x){ entries.set(fill[x]++, i); });
+    }
+    return CompressedChains(IndexArray(std::move(offsets)), std::move(entries));
+  }
+
+  /// memory
+  ///   Bytes used by the offset and entry arrays
+  Integer
+  memory ( void ) const {
+    return offsets_.memory() + entries_.memory();
+  }
+
+private:
+  IndexArray offsets_;
+  IndexArray entries_;
+};
@@ -14,17 +14,25 @@
 #include "MorseMatching.h"
 #include "GradedComplex.h"
 #include "MorseGradedComplex.h"
+#include "Progress.h"
+#include "Instrumentation.h"
+#include "ResultCache.h"
 
 /// ConnectionMatrix
 inline
 std::shared_ptr<GradedComplex> 
 ConnectionMatrix ( std::shared_ptr<GradedComplex> base ) {
-  std::shared_ptr<GradedComplex> next = base;
-  do {
-    base = next;
-    next = MorseGradedComplex(base);
-  } while ( next -> complex() -> size() != base -> complex() -> size() );
-  return base;
+  return ResultCache::instance().fetch<GradedComplex>(ResultCache::CONNECTION_MATRIX,
+    base -> complex(), base, [&](){
+    StageTimer timer ( "connection matrix" );
+    std::shared_ptr<GradedComplex> next = base;
+    do {
+      base = next;
+      next = MorseGradedComplex(base);
+      Instrumentation::instance().append("critical cells per level", next -> complex() -> size());
+    } while ( next -> complex() -> size() != base -> complex() -> size() );
+    return base;
+  });
 }
 
 /// ConnectionMatrix
@@ -34,10 +42,12 @@ ConnectionMatrixTower ( std::shared_ptr<GradedComplex> base ) {
   std::vector<std::shared_ptr<GradedComplex>> tower;
   std::shared_ptr<GradedComplex> next = base;
   std::shared_ptr<GradedComplex> last;
+  StageTimer timer ( "connection matrix" );
   do {
     tower.push_back(next);
     last = tower.back();
     next = MorseGradedComplex(last);
+    Instrumentation::instance().append("critical cells per level", next -> complex() -> size());
   } while ( next -> complex() -> size() != last -> complex() -> size() );
   return tower;
 }
@@ -50,7 +60,18 @@ namespace py = pybind11;
 
 inline
 void ConnectionMatrixBinding(py::module &m) {
-  m.def("ConnectionMatrix", &ConnectionMatrix);
-  m.def("ConnectionMatrixTower", &ConnectionMatrixTower);
-
+  m.def("ConnectionMatrix", [](std::shared_ptr<GradedComplex> base, py::object progress,
+                               std::shared_ptr<CancellationToken> token, double interval) {
+    return with_progress(progress, token, interval, [&](){
+      return ConnectionMatrix(base);
+    });
+  }, py::arg("base"), py::arg("progress") = py::none(),
+     py::arg("token") = py::none(), py::arg("interval") = 0.1);
+  m.def("ConnectionMatrixTower", [](std::shared_ptr<GradedComplex> base, py::object progress,
+                                    std::shared_ptr<CancellationToken> token, double interval) {
+    return with_progress(progress, token, interval, [&](){
+      return ConnectionMatrixTower(base);
+    });
+  }, py::arg("base"), py::arg("progress") = py::none(),
+     py::arg("token") = py::none(), py::arg("interval") = 0.1);
 }
@@ -16,6 +16,14 @@
 
 /// CubicalComplex
 ///   Implements a trivial cubical complex with Z_2 coefficients
+///   Two boundary modes are supported:
+///     periodic (default) : "twisted" periodic boundary conditions. Every
+///       shape has prod(boxes) cells, and cells on the far right wrap
+///       around (see rightfringe).
+///     non-periodic : the full box [0,boxes[0]] x ... x [0,boxes[D-1]].
+///       There are no fringe cells; cells of each shape are indexed in
+///       mixed radix (boxes[d] positions in dimensions with extent,
+///       boxes[d]+1 in the others), so no padding is needed.
 ///   Methods:
 ///     ImageComplex : Initialize the complex with width N and height M
 ///     boundary : given a cell, returns an array of boundary cells
@@ -30,20 +38,22 @@ public:
   /// CubicalComplex
   ///   Initialize the complex that is boxes[i] boxes across 
   ///   in dimensions d = 0, 1, ..., boxes.size() - 1
-  ///   Note: The cubical complex does not have cells on the 
+  ///   Note: The periodic cubical complex does not have cells on the 
   ///         far right, so to have a "full" cubical 
-  ///         complex as a subcomplex, pad with an extra box.
-  CubicalComplex ( std::vector<Integer> const& boxes ) {
-    assign ( boxes );
+  ///         complex as a subcomplex, pad with an extra box
+  ///         (or use periodic = false).
+  CubicalComplex ( std::vector<Integer> const& boxes, bool periodic = true ) {
+    assign ( boxes, periodic );
   }
 
   /// assign
   ///   Initialize the complex that is boxes[i] boxes across 
   ///   in dimensions d = 0, 1, ..., boxes.size() - 1
   void
-  assign ( std::vector<Integer> const& boxes ) {
+  assign ( std::vector<Integer> const& boxes, bool periodic = true ) {
     // Get dimension
     Integer D = boxes.size();
+    periodic_ = periodic;
 
     // Compute PV := [1, boxes[0], boxes[0]*boxes[1], ..., boxes[0]*boxes[1]*...*boxes[D-1]]
     auto & PV = place_values_;
@@ -75,12 +85,34 @@ public:
     std::stable_sort(ST.begin(), ST.end(), compare);
     for ( Integer type = 0; type < M; ++ type) TS[ST[type]] = type; 
 
+    // Place values of positions within each shape. In periodic mode every
+    // shape has place values PV; otherwise dimensions without extent
+    // have one more position (the far right vertex/face).
+    shape_place_values_.resize ( M * (D+1) );
+    for ( Integer shape = 0; shape < M; ++ shape ) {
+      Integer * pv = &shape_place_values_[shape * (D+1)];
+      pv[0] = 1;
+      for ( Integer d = 0; d < D; ++ d ) {
+        bool extra = not periodic && not (shape & (1L << d));
+        pv[d+1] = pv[d] * (boxes[d] + (extra ? 1 : 0));
+      }
+    }
+
+    // First cell of each type
+    type_begin_.resize ( M + 1 );
+    type_begin_[0] = 0;
+    for ( Integer type = 0; type < M; ++ type ) {
+      type_begin_[type+1] = type_begin_[type] + shape_place_values_[ST[type] * (D+1) + D];
+    }
+    N = type_begin_[M];
+
     // Set up iterator bounds for every dimension
+    begin_ . clear ();
     begin_ . resize ( dimension() + 2, N );
-    for ( Integer type = 0, idx = 0; type < M; ++ type, idx += L ) {
+    for ( Integer type = 0; type < M; ++ type ) {
       Integer shape = ST[type];
       Integer dim = popcount_(shape);
-      begin_[dim] = Iterator(std::min(*begin_[dim], idx));
+      begin_[dim] = Iterator(std::min(*begin_[dim], type_begin_[type]));
     }
 
     // Set up topstar_offset_ data structure
@@ -93,11 +125,25 @@ public:
         }
       }
     }
+
+    // Set up parallelneighbors offsets
+    build_parallel_table_ ();
   }
 
   /// column
   virtual void
   column ( Integer cell, std::function<void(Integer)> const& callback ) const final {
+    // explicit template argument, so as not to call this overload again
+    column<std::function<void(Integer)>>(cell, callback);
+  }
+
+  /// column
+  ///   As above, calling callback directly rather than through
+  ///   std::function (see DualComplex)
+  template < typename F >
+  void
+  column ( Integer cell, F const& callback ) const {
+    if ( not periodic_ ) return acyclic_column_(cell, callback);
     Integer shape = cell_shape(cell);
     Integer position = cell % type_size();
     for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
@@ -113,9 +159,48 @@ public:
     }
   }
 
+  /// signed_column
+  ///   The faces of a cell to the left and to the right in its ith
+  ///   dimension of extent (counting from 0) have coefficients -(-1)^i
+  ///   and (-1)^i. In periodic mode the two may coincide, and cancel.
+  virtual void
+  signed_column ( Integer cell, std::function<void(Integer,Integer)> const& callback ) const final {
+    Integer shape = cell_shape(cell);
+    Integer x [ 64 ];
+    if ( not periodic_ ) coordinates(cell, x);
+    Integer position = cell % type_size();
+    Integer sign = 1;
+    for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
+      if ( not (shape & bit) ) continue;
+      Integer left, right;
+      if ( periodic_ ) {
+        Integer type_offset = type_size() * ( TS() [ shape ^ bit ] );
+        Integer right_position = position + PV()[d];
+        if (right_position >= type_size()) right_position -= type_size();
+        left = position + type_offset;
+        right = right_position + type_offset;
+      } else {
+        left = cell_index(x, shape ^ bit);
+        right = left + shape_place_values(shape ^ bit)[d];
+      }
+      callback( left, -sign );
+      callback( right, sign );
+      sign = -sign;
+    }
+  }
+
   /// row
   virtual void
   row ( Integer cell, std::function<void(Integer)> const& callback ) const final {
+    row<std::function<void(Integer)>>(cell, callback);
+  }
+
+  /// row
+  ///   As above, calling callback directly
+  template < typename F >
+  void
+  row ( Integer cell, F const& callback ) const {
+    if ( not periodic_ ) return acyclic_row_(cell, callback);
     Integer shape = cell_shape(cell);
     Integer position = cell % type_size();
     for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
@@ -134,72 +219,141 @@ public:
   ///   note: assumed twisted periodic conditions
   virtual std::vector<Integer>
   topstar ( Integer cell ) const {
-    std::vector<Integer> result;
+    std::vector<Integer> result ( ((Integer)1) << (dimension() - cell_dim(cell)) );
+    result.resize ( topstar(cell, result.data()) );
+    return result;
+  }
+
+  /// topstar
+  ///   Write the top dimensional cells in the star of cell into result,
+  ///   which needs room for 2^(dimension() - cell_dim(cell)) of them,
+  ///   and return how many were written
+  Integer
+  topstar ( Integer cell, Integer * result ) const {
+    Integer * out = result;
+    topstar(cell, [&](Integer v){ *out++ = v; });
+    return out - result;
+  }
+
+  /// topstar
+  ///   Call callback on each top dimensional cell in the star of cell.
+  ///   These are the top cells to the left of cell in a subset s of the
+  ///   dimensions in which cell has no extent; only such subsets are
+  ///   visited (in increasing order, so the order is that of topstar).
+  template < typename F >
+  void
+  topstar ( Integer cell, F const& callback ) const {
     Integer shape = cell_shape(cell);
-    // Loop through dimension()-bit bitcodes
-    Integer M = 1L << dimension(); // i.e. 2^dimension()
-    // Compute the topcell x we get by expanding cell to the right in all collapsed dimensions:
-    Integer position = cell % type_size(); // (M-1)==(2^D-1) is type of a topcell
-    Integer offset = type_size() * (M-1);
-    // std::cout << " cell = " << cell << "\n";
-    // std::cout << "all-1's topcell = " << x << "\n";
-    for ( Integer i = 0; i < M; ++ i ) {
-      if ( (shape & ~i ) == 0 ) { // if shape bit is one, then index i bit must be on.
-        // i is a valid offset
-        // std::cout << " shape = " << shape << " i == " << i << "\n";
-        // std::cout << " i = " << i << "\n";
-        // std::cout << " topstar_offset_[i] = " << topstar_offset_[i] << "\n";
-        result.push_back(offset + (position + topstar_offset_[i] + type_size() ) % type_size());
-      } else {
-        // TODO skip many invalid indices simultaneously
-      }
+    Integer top = num_types_ - 1;
+    Integer free = top & ~shape;
+    if ( periodic_ ) {
+      Integer L = type_size();
+      Integer position = cell % L;
+      Integer offset = L * top;
+      Integer s = 0;
+      do {
+        Integer k = position + topstar_offset_[shape | s];
+        if ( k < 0 ) { k %= L; if ( k < 0 ) k += L; }
+        callback(offset + k);
+        s = (s - free) & free; // next subset of free
+      } while ( s != 0 );
+      return;
     }
-    return result;
+    // Non-periodic: in a free dimension the top cell to the left does not
+    // exist at coordinate 0 and the one to the right does not exist at
+    // coordinate boxes[d], so the latter dimensions are always in s.
+    Integer x [ 64 ];
+    coordinates(cell, x);
+    Integer low = 0, high = 0;
+    for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
+      if ( not (free & bit) ) continue;
+      if ( x[d] == 0 ) low |= bit;
+      if ( x[d] == boxes_[d] ) high |= bit;
+    }
+    Integer choice = free & ~low & ~high;
+    Integer right = type_begin_[top];
+    for ( Integer d = 0; d < dimension(); ++ d ) right += x[d] * place_values_[d];
+    Integer s = 0;
+    do {
+      // topstar_offset_[top & ~t] == -sum(PV[d] for d in t)
+      callback(right + topstar_offset_[top & ~(s | high)]);
+      s = (s - choice) & choice;
+    } while ( s != 0 );
   }
 
   /// parallelneighbors
-  ///   return top dimensional cells in star
+  ///   return cells of the same shape whose coordinates differ from
+  ///   those of cell by at most one in the dimensions in which it has
+  ///   extent (including cell itself)
   ///   note: assumed twisted periodic conditions
   std::vector<Integer>
   parallelneighbors ( Integer cell ) const {
-    Integer shape = cell_shape(cell);
-    Integer position = cell % type_size();
-    Integer type_offset = type_size() * TS() [ shape ];
     std::vector<Integer> result;
-    auto record = [&](Integer offset) {
-      Integer k = position + offset;
-      if ( k >= type_size()) k -= type_size(); else if ( k < 0 ) k += type_size();
-      result.push_back(k + type_offset);
-    };
-    auto D = dimension();
-    std::vector<int> x(D, -1);
-    Integer offset = 0;
-    for ( Integer d = 0, bit = 1; d < D; ++ d, bit <<= (Integer) 1 ) if ( shape & bit ) offset -= PV()[d];
-    record(offset);
-    while (1) {
-      for ( Integer d = 0, bit = 1; d <= D; ++ d, bit <<= (Integer) 1 ) {
-        if ( d == D ) return result;
-        if ( shape & bit ) {
-          if ( ++x[d] == 2 ) { 
-            x[d] = -1; 
-            offset -= 2*PV()[d];
-          } else { 
-            offset += PV()[d];
-            record(offset);
-            break;
-          }
-        }
+    parallelneighbors(cell, [&](Integer v){ result.push_back(v); });
+    return result;
+  }
+
+  /// parallelneighbors
+  ///   Write the parallel neighbors of cell into result, which needs
+  ///   room for 3^cell_dim(cell) of them, and return how many were written
+  Integer
+  parallelneighbors ( Integer cell, Integer * result ) const {
+    Integer * out = result;
+    parallelneighbors(cell, [&](Integer v){ *out++ = v; });
+    return out - result;
+  }
+
+  /// parallelneighbors
+  ///   Call callback on each parallel neighbor of cell, in the order of
+  ///   offsets -1, 0, 1 in each dimension with extent, first dimension
+  ///   fastest. Offsets come from a per-shape table when dimension() is
+  ///   at most max_parallel_table_dimension.
+  template < typename F >
+  void
+  parallelneighbors ( Integer cell, F const& callback ) const {
+    if ( parallel_table_begin_.empty() ) return parallelneighbors_odometer_(cell, callback);
+    Integer shape = cell_shape(cell);
+    ParallelOffset const* first = parallel_table_.data() + parallel_table_begin_[shape];
+    ParallelOffset const* last = parallel_table_.data() + parallel_table_begin_[shape+1];
+    if ( periodic_ ) {
+      Integer L = type_size();
+      Integer position = cell % L;
+      Integer type_offset = cell - position;
+      for ( auto p = first; p != last; ++ p ) {
+        Integer k = position + p -> offset;
+        if ( k >= L ) k -= L; else if ( k < 0 ) k += L;
+        callback(k + type_offset);
       }
+      return;
+    }
+    Integer x [ 64 ];
+    coordinates(cell, x);
+    Integer low = 0, high = 0;
+    for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
+      if ( not (shape & bit) ) continue;
+      if ( x[d] == 0 ) low |= bit;
+      if ( x[d] + 1 == boxes_[d] ) high |= bit;
+    }
+    for ( auto p = first; p != last; ++ p ) {
+      if ( (p -> minus & low) || (p -> plus & high) ) continue;
+      callback(cell + p -> offset);
     }
   }
 
+  /// max_parallel_table_dimension
+  ///   Largest dimension for which parallelneighbors offsets are tabulated
+  ///   (the table has 4^dimension() entries)
+  static constexpr Integer max_parallel_table_dimension = 8;
+
   /// Features
 
   /// left
   ///   Give cell to "left" in given dimension. 
   ///   Note: uses "twisted" periodic boundary conditions (inconsistent with periodic and acyclic conditions)
+  ///         In non-periodic mode, returns -1 if there is no such cell.
   Integer
   left ( Integer cell, Integer dim ) const {
+    if ( not periodic_ ) return acyclic_neighbor_(cell, dim, false);
     Integer shape = cell_shape(cell);
     Integer bit = ((Integer)1) << dim;
     Integer position = cell % type_size();
@@ -212,8 +366,10 @@ public:
   /// right
   ///   Give cell to "right" in given dimension. 
   ///   Note: uses "twisted" periodic boundary conditions (inconsistent with periodic and acyclic conditions)
+  ///         In non-periodic mode, returns -1 if there is no such cell.
   Integer
   right ( Integer cell, Integer dim ) const {
+    if ( not periodic_ ) return acyclic_neighbor_(cell, dim, true);
     Integer shape = cell_shape(cell);
     Integer bit = ((Integer)1) << dim;
     Integer position = cell % type_size();
@@ -225,8 +381,10 @@ public:
 
   /// leftfringe
   ///   cells for which left coboundary wraps around if periodic
+  ///   (there are none in non-periodic mode)
   bool
   leftfringe ( Integer cell ) const {
+    if ( not periodic_ ) return false;
     Integer shape = cell_shape(cell);
     lldiv_t coordinate = {(int64_t)cell, 0}; // (quotient, remainder), see std::div
     for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
@@ -239,8 +397,10 @@ public:
 
   /// rightfringe
   ///    Return true if right boundary would wrap around if periodic 
+  ///    (there are none in non-periodic mode)
   bool
   rightfringe ( Integer cell ) const {
+    if ( not periodic_ ) return false;
     Integer shape = cell_shape(cell);
     lldiv_t coordinate = {(int64_t)cell, 0}; // (quotient, remainder), see std::div
     for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
@@ -257,6 +417,11 @@ public:
   Integer
   mincoords ( Integer cell ) const {
     Integer result = 0;
+    if ( not periodic_ ) {
+      auto x = coordinates(cell);
+      for ( Integer d = 0; d < dimension(); ++ d ) if ( x[d] == 0 ) result |= (1L << d);
+      return result;
+    }
     lldiv_t coordinate = {(int64_t)cell, 0}; // (quotient, remainder), see std::div
     for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
       coordinate = std::lldiv(static_cast<Integer>(coordinate.quot), boxes()[d] ); 
@@ -271,6 +436,12 @@ public:
   Integer
   maxcoords ( Integer cell ) const {
     Integer result = 0;
+    if ( not periodic_ ) {
+      auto x = coordinates(cell);
+      Integer const* pv = shape_place_values(cell_shape(cell));
+      for ( Integer d = 0; d < dimension(); ++ d ) if ( x[d] + 1 == pv[d+1] / pv[d] ) result |= (1L << d);
+      return result;
+    }
     lldiv_t coordinate = {(int64_t)cell, 0}; // (quotient, remainder), see std::div
     for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
       coordinate = std::lldiv(static_cast<Integer>(coordinate.quot), boxes()[d] ); 
@@ -292,10 +463,7 @@ public:
   std::vector<Integer>
   coordinates ( Integer cell ) const {
     std::vector<Integer> result ( dimension() );
-    for ( Integer d = 0; d < dimension(); ++ d ) {
-      result[d] = cell % boxes()[d];
-      cell /= boxes()[d];
-    }
+    coordinates(cell, result.data());
     return result;
   }
 
@@ -315,13 +483,13 @@ public:
   /// shape_begin
   Iterator
   shape_begin ( Integer shape ) const {
-    return Iterator(TS()[shape] * type_size());
+    return Iterator(type_begin_[TS()[shape]]);
   }
 
   /// shape_end
   Iterator
   shape_end ( Integer shape ) const {
-    return Iterator(TS()[shape] * ( type_size() + 1));
+    return Iterator(type_begin_[TS()[shape] + 1]);
   }
 
   /// cell_type
@@ -329,7 +497,8 @@ public:
   ///   Interpretation: if ( shape & ( 1 << i ) ) { then the cell has extent in dimension i }
   Integer
   cell_type ( Integer cell ) const {
-    return cell / type_size();
+    if ( periodic_ ) return cell / type_size();
+    return std::upper_bound(type_begin_.begin(), type_begin_.end(), cell) - type_begin_.begin() - 1;
   }
 
   /// cell_shape
@@ -342,22 +511,18 @@ public:
   }
 
   /// cell_pos
+  ///   Position of a cell among the cells of its shape
   Integer
   cell_pos ( Integer cell ) const {
-    return cell % type_size();
+    if ( periodic_ ) return cell % type_size();
+    return cell - type_begin_[cell_type(cell)];
   }
 
   /// cell_index
   Integer
   cell_index ( std::vector<Integer> const& coordinates, 
-               Integer shape ) {
-    Integer cell = 0;
-    for ( Integer d = dimension() - 1; d >= 0; -- d ) {
-      cell *= boxes()[d];
-      cell += coordinates[d];
-    }
-    cell += TS() [ shape ] * type_size();
-    return cell;
+               Integer shape ) const {
+    return cell_index(coordinates.data(), shape);
   }
 
   /// cell_dim
@@ -367,23 +532,149 @@ public:
     return popcount_(cell_shape(cell));
   }
 
+  /// Bulk accessors
+  ///   Each of these applies the corresponding single-cell method to
+  ///   cells[0], ..., cells[N-1] and writes into caller-provided storage,
+  ///   using the pointer overloads of the single-cell methods (those that
+  ///   return std::vector allocate per call). They touch no Python
+  ///   objects, so the Python bindings call them with the GIL released.
+
+  /// coordinates_many
+  ///   Write coordinates of N cells as rows of an N x dimension() array
+  void
+  coordinates_many ( Integer const* cells, Integer N, Integer * result ) const {
+    Integer D = dimension();
+    for ( Integer i = 0; i < N; ++ i ) {
+      coordinates(checked_cell_(cells[i]), result + i*D);
+    }
+  }
+
+  /// barycenter_many
+  ///   Write barycenters of N cells as rows of an N x dimension() array
+  void
+  barycenter_many ( Integer const* cells, Integer N, Integer * result ) const {
+    Integer D = dimension();
+    coordinates_many ( cells, N, result );
+    for ( Integer i = 0; i < N; ++ i ) {
+      Integer shape = cell_shape(cells[i]);
+      for ( Integer d = 0, bit = 1; d < D; ++ d, bit <<= (Integer) 1 ) {
+        result[i*D+d] = (result[i*D+d] << (Integer) 1) + ((shape & bit) ? 1 : 0);
+      }
+    }
+  }
+
+  /// cell_shape_many
+  void
+  cell_shape_many ( Integer const* cells, Integer N, Integer * result ) const {
+    for ( Integer i = 0; i < N; ++ i ) result[i] = cell_shape(checked_cell_(cells[i]));
+  }
+
+  /// cell_dim_many
+  void
+  cell_dim_many ( Integer const* cells, Integer N, Integer * result ) const {
+    for ( Integer i = 0; i < N; ++ i ) result[i] = cell_dim(checked_cell_(cells[i]));
+  }
+
+  /// cell_index_many
+  ///   Given an N x dimension() array of coordinates and N shapes,
+  ///   write the N corresponding cell indices
+  void
+  cell_index_many ( Integer const* coordinates, Integer const* shapes,
+                    Integer N, Integer * result ) const {
+    Integer D = dimension();
+    for ( Integer i = 0; i < N; ++ i ) {
+      if ( shapes[i] < 0 || shapes[i] >= num_types_ ) {
+        throw std::invalid_argument("CubicalComplex::cell_index_many: invalid shape");
+      }
+      Integer const* pv = shape_place_values(shapes[i]);
+      for ( Integer d = 0; d < D; ++ d ) {
+        Integer x = coordinates[i*D+d];
+        if ( x < 0 || x >= pv[d+1] / pv[d] ) {
+          throw std::invalid_argument("CubicalComplex::cell_index_many: coordinate out of range");
+        }
+      }
+      result[i] = cell_index(coordinates + i*D, shapes[i]);
+    }
+  }
+
+  /// topstar_count_many
+  ///   Write the number of top cells in the star of each of N cells
+  ///   (2^(D - cell_dim) in periodic mode), as used to size topstar_many output
+  void
+  topstar_count_many ( Integer const* cells, Integer N, Integer * result ) const {
+    parallel_for(0, N, [&](Integer i){
+      Integer cell = checked_cell_(cells[i]);
+      if ( periodic_ ) {
+        result[i] = ((Integer)1) << (dimension() - cell_dim(cell));
+      } else {
+        Integer count = 0;
+        topstar(cell, [&](Integer){ ++ count; });
+        result[i] = count;
+      }
+    });
+  }
+
+  /// topstar_many
+  ///   Write the top star of cells[i] into result starting at offsets[i]
+  ///   (the partial sums of topstar_count_many)
+  void
+  topstar_many ( Integer const* cells, Integer N, Integer const* offsets,
+                 Integer * result ) const {
+    parallel_for(0, N, [&](Integer i){
+      topstar(checked_cell_(cells[i]), result + offsets[i]);
+    });
+  }
+
+  /// parallelneighbors_count_many
+  ///   Write the number of parallel neighbors of each of N cells
+  ///   (3^cell_dim in periodic mode), as used to size parallelneighbors_many output
+  void
+  parallelneighbors_count_many ( Integer const* cells, Integer N, Integer * result ) const {
+    parallel_for(0, N, [&](Integer i){
+      Integer cell = checked_cell_(cells[i]);
+      Integer count = 0;
+      if ( periodic_ ) {
+        count = 1;
+        for ( Integer k = cell_dim(cell); k > 0; -- k ) count *= 3;
+      } else {
+        parallelneighbors(cell, [&](Integer){ ++ count; });
+      }
+      result[i] = count;
+    });
+  }
+
+  /// parallelneighbors_many
+  ///   Write the parallel neighbors of cells[i] into result starting at
+  ///   offsets[i] (the partial sums of parallelneighbors_count_many)
+  void
+  parallelneighbors_many ( Integer const* cells, Integer N, Integer const* offsets,
+                           Integer * result ) const {
+    parallel_for(0, N, [&](Integer i){
+      parallelneighbors(checked_cell_(cells[i]), result + offsets[i]);
+    });
+  }
+
   /// operator ==
   bool
   operator == ( CubicalComplex const& rhs ) const {
-    return boxes() == rhs.boxes();
+    return boxes() == rhs.boxes() && periodic() == rhs.periodic();
   }
 
   /// operator <
   bool
   operator < ( CubicalComplex const& rhs ) const {
-    return std::lexicographical_compare(boxes().begin(), boxes().end(),
+    if ( boxes() != rhs.boxes() ) {
+      return std::lexicographical_compare(boxes().begin(), boxes().end(),
                                           rhs.boxes().begin(), rhs.boxes().end());
+    }
+    return periodic() < rhs.periodic();
   }
 
   /// operator <<
   friend std::ostream & operator << ( std::ostream & stream, CubicalComplex const& stream_me ) {
     stream << "CubicalComplex([";
     for ( auto x : stream_me.boxes() ) stream << x << ",";
+    if ( not stream_me.periodic() ) return stream << "], periodic=False)";
     return stream << "])";
   }
 
@@ -396,11 +687,27 @@ public:
     std::cout << "  shape(" << cell_index << ") = " << cell_shape(cell_index) << "\n";
   }
 
+  /// type_size
+  ///   prod(boxes), i.e. the number of cells of each shape in periodic mode
   Integer
   type_size ( void ) const {
     return type_size_;
   }
 
+  /// periodic
+  ///   True for twisted periodic boundary conditions
+  bool
+  periodic ( void ) const {
+    return periodic_;
+  }
+
+  /// type_begin
+  ///   First cell of each type (type_begin()[num_types] == size())
+  std::vector<Integer> const&
+  type_begin ( void ) const {
+    return type_begin_;
+  }
+
   /// TS
   ///   Given shape, return type
   std::vector<Integer> const&
@@ -416,14 +723,205 @@ public:
   }
 
   /// PV
-  ///   Return 
+  ///   Return place values [1, boxes[0], boxes[0]*boxes[1], ...] of
+  ///   positions (of top cells, in non-periodic mode)
   std::vector<Integer> const&
   PV ( void ) const {
     return place_values_;
   }
 
+  /// cell_index
+  ///   Cell with coordinates x[0], ..., x[dimension()-1] and given shape.
+  ///   Coordinates are not checked.
+  Integer
+  cell_index ( Integer const* x, Integer shape ) const {
+    Integer const* pv = shape_place_values(shape);
+    Integer cell = type_begin_[TS()[shape]];
+    for ( Integer d = 0; d < dimension(); ++ d ) cell += x[d] * pv[d];
+    return cell;
+  }
+
+  /// coordinates
+  ///   Write coordinates of cell into x[0], ..., x[dimension()-1]
+  void
+  coordinates ( Integer cell, Integer * x ) const {
+    Integer D = dimension();
+    if ( periodic_ ) {
+      for ( Integer d = 0; d < D; ++ d ) {
+        x[d] = cell % boxes_[d];
+        cell /= boxes_[d];
+      }
+      return;
+    }
+    Integer type = cell_type(cell);
+    Integer position = cell - type_begin_[type];
+    Integer const* pv = shape_place_values(ST()[type]);
+    for ( Integer d = 0; d < D; ++ d ) {
+      Integer radix = pv[d+1] / pv[d];
+      x[d] = position % radix;
+      position /= radix;
+    }
+  }
+
+  /// shape_place_values
+  ///   Place values of positions of cells of the given shape
+  ///   (dimension()+1 of them, the last being the number of such cells)
+  Integer const*
+  shape_place_values ( Integer shape ) const {
+    return &shape_place_values_[shape * (dimension() + 1)];
+  }
+
 private:
 
+  /// Non-periodic mode
+  ///   Neighbors are found by converting to coordinates and back.
+  ///   Cells with extent in dimension d have coordinates 0..boxes[d]-1 in
+  ///   that dimension, others 0..boxes[d].
+
+  template < typename F >
+  void
+  acyclic_column_ ( Integer cell, F const& callback ) const {
+    Integer x [ 64 ]; // shapes are bitmasks, so dimension() < 64
+    coordinates(cell, x);
+    Integer shape = cell_shape(cell);
+    for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
+      if ( not (shape & bit) ) continue;
+      Integer left = cell_index(x, shape ^ bit);
+      callback( left );
+      callback( left + shape_place_values(shape ^ bit)[d] );
+    }
+  }
+
+  template < typename F >
+  void
+  acyclic_row_ ( Integer cell, F const& callback ) const {
+    Integer x [ 64 ];
+    coordinates(cell, x);
+    Integer shape = cell_shape(cell);
+    for ( Integer d = 0, bit = 1; d < dimension(); ++ d, bit <<= 1L ) {
+      if ( shape & bit ) continue;
+      Integer right = cell_index(x, shape ^ bit);
+      if ( x[d] < boxes_[d] ) callback( right );
+      if ( x[d] > 0 ) callback( right - shape_place_values(shape ^ bit)[d] );
+    }
+  }
+
+  /// ParallelOffset
+  ///   Entry of the parallelneighbors table: offset of the neighbor's
+  ///   index, and the dimensions in which it lies to the left (minus)
+  ///   or to the right (plus)
+  struct ParallelOffset {
+    Integer offset;
+    Integer minus;
+    Integer plus;
+  };
+
+  /// parallel_table_
+  ///   Tabulate the neighbor offsets of every shape, in the order
+  ///   visited by parallelneighbors_odometer_
+  void
+  build_parallel_table_ ( void ) {
+    parallel_table_.clear();
+    parallel_table_begin_.clear();
+    if ( dimension() > max_parallel_table_dimension ) return;
+    Integer D = dimension();
+    parallel_table_begin_.push_back(0);
+    for ( Integer shape = 0; shape < num_types_; ++ shape ) {
+      Integer const* pv = shape_place_values(shape);
+      std::vector<Integer> dims;
+      for ( Integer d = 0; d < D; ++ d ) if ( shape & (1L << d) ) dims.push_back(d);
+      std::vector<int> digit ( dims.size(), -1 );
+      while ( 1 ) {
+        ParallelOffset p = { 0, 0, 0 };
+        for ( Integer j = 0; j < (Integer) dims.size(); ++ j ) {
+          p.offset += digit[j] * pv[dims[j]];
+          if ( digit[j] < 0 ) p.minus |= 1L << dims[j];
+          if ( digit[j] > 0 ) p.plus |= 1L << dims[j];
+        }
+        parallel_table_.push_back(p);
+        Integer j = 0;
+        for ( ; j < (Integer) dims.size(); ++ j ) {
+          if ( ++ digit[j] == 2 ) digit[j] = -1; else break;
+        }
+        if ( j == (Integer) dims.size() ) break;
+      }
+      parallel_table_begin_.push_back(parallel_table_.size());
+    }
+  }
+
+  /// parallelneighbors_odometer_
+  ///   parallelneighbors without the offset table (for large dimension)
+  template < typename F >
+  void
+  parallelneighbors_odometer_ ( Integer cell, F const& callback ) const {
+    Integer shape = cell_shape(cell);
+    Integer D = dimension();
+    if ( not periodic_ ) {
+      Integer x [ 64 ], y [ 64 ];
+      coordinates(cell, x);
+      Integer const* pv = shape_place_values(shape);
+      // offsets in {-1, 0, 1} in each dimension with extent, first dimension fastest
+      std::vector<int> offset ( D, -1 );
+      while ( 1 ) {
+        bool valid = true;
+        for ( Integer d = 0, bit = 1; d < D; ++ d, bit <<= 1L ) {
+          y[d] = x[d] + ((shape & bit) ? offset[d] : 0);
+          if ( y[d] < 0 || y[d] >= pv[d+1] / pv[d] ) valid = false;
+        }
+        if ( valid ) callback(cell_index(y, shape));
+        Integer d = 0;
+        for ( ; d < D; ++ d ) {
+          if ( not (shape & (1L << d)) ) continue;
+          if ( ++ offset[d] == 2 ) offset[d] = -1; else break;
+        }
+        if ( d == D ) return;
+      }
+    }
+    Integer position = cell % type_size();
+    Integer type_offset = type_size() * TS() [ shape ];
+    auto record = [&](Integer offset) {
+      Integer k = position + offset;
+      if ( k >= type_size()) k -= type_size(); else if ( k < 0 ) k += type_size();
+      callback(k + type_offset);
+    };
+    std::vector<int> x(D, -1);
+    Integer offset = 0;
+    for ( Integer d = 0, bit = 1; d < D; ++ d, bit <<= (Integer) 1 ) if ( shape & bit ) offset -= PV()[d];
+    record(offset);
+    while (1) {
+      for ( Integer d = 0, bit = 1; d <= D; ++ d, bit <<= (Integer) 1 ) {
+        if ( d == D ) return;
+        if ( shape & bit ) {
+          if ( ++x[d] == 2 ) {
+            x[d] = -1;
+            offset -= 2*PV()[d];
+          } else {
+            offset += PV()[d];
+            record(offset);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  Integer
+  acyclic_neighbor_ ( Integer cell, Integer dim, bool right ) const {
+    Integer x [ 64 ];
+    coordinates(cell, x);
+    Integer shape = cell_shape(cell);
+    Integer bit = ((Integer)1) << dim;
+    if ( shape & bit ) {
+      // face: left one has the same coordinates
+      if ( right ) x[dim] += 1;
+    } else {
+      // coface: the right one has the same coordinates
+      if ( not right ) x[dim] -= 1;
+      if ( x[dim] < 0 || x[dim] >= boxes_[dim] ) return -1;
+    }
+    return cell_index(x, shape ^ bit);
+  }
+
   Integer
   popcount_ ( Integer x ) const {
     // http://lemire.me/blog/2016/05/23/the-surprising-cleverness-of-modern-compilers/
@@ -431,14 +929,29 @@ private:
     while(x != 0) { x &= x - 1; ++pcnt; } 
     return pcnt;
   }
+
+  /// checked_cell_
+  ///   Pass through a cell index, throwing if it is out of range
+  Integer
+  checked_cell_ ( Integer cell ) const {
+    if ( cell < 0 || cell >= size() ) {
+      throw std::invalid_argument("CubicalComplex: cell index out of range");
+    }
+    return cell;
+  }
 private:
   std::vector<Integer> boxes_;
   std::vector<Integer> place_values_;
   std::vector<Integer> shape_from_type_;
   std::vector<Integer> type_from_shape_;
   std::vector<Integer> topstar_offset_;
+  std::vector<Integer> shape_place_values_;
+  std::vector<Integer> type_begin_;
+  std::vector<ParallelOffset> parallel_table_;
+  std::vector<Integer> parallel_table_begin_;
   Integer num_types_;
   Integer type_size_;
+  bool periodic_ = true;
 };
 
 /// std::hash<CubicalComplex>
@@ -453,6 +966,7 @@ namespace std {
       for ( auto x : complex.boxes() ) {
         hash_combine(seed,hash_value(x));
       }         
+      if ( not complex.periodic() ) hash_combine(seed,hash_value(1));
       return seed;
     }
   };
@@ -462,26 +976,120 @@ namespace std {
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 namespace py = pybind11;
 
+/// cells_size_
+///   Length of a one-dimensional array of cells
+inline py::ssize_t
+cells_size_ ( IntegerArray const& cells ) {
+  if ( cells.ndim() != 1 ) {
+    throw std::invalid_argument("expected a one-dimensional array of cells");
+  }
+  return cells.shape(0);
+}
+
+/// ragged_many_
+///   Run a bulk accessor with variable-length output per cell: count(cells,
+///   N, counts), then fill(cells, N, offsets, out). Returns (offsets, out).
+template < typename Count, typename Fill >
+py::tuple
+ragged_many_ ( IntegerArray const& cells, Count const& count, Fill const& fill ) {
+  auto N = cells_size_(cells);
+  IntegerArray offsets(N+1);
+  Integer * offsets_out = offsets.mutable_data();
+  {
+    py::gil_scoped_release release;
+    offsets_out[0] = 0;
+    count(cells.data(), N, offsets_out + 1);
+    std::partial_sum(offsets_out, offsets_out + N + 1, offsets_out);
+  }
+  IntegerArray result(offsets_out[N]);
+  Integer * out = result.mutable_data();
+  {
+    py::gil_scoped_release release;
+    fill(cells.data(), N, offsets_out, out);
+  }
+  return py::make_tuple(offsets, result);
+}
+
 inline void
 CubicalComplexBinding(py::module &m) {
   py::class_<CubicalComplex, std::shared_ptr<CubicalComplex>, Complex>(m, "CubicalComplex")
     .def(py::init<>())
-    .def(py::init<std::vector<Integer> const&>())
+    .def(py::init<std::vector<Integer> const&, bool>(),
+         py::arg("boxes"), py::arg("periodic") = true)
     .def("boxes", &CubicalComplex::boxes)
-    .def("coordinates", &CubicalComplex::coordinates)
+    .def("periodic", &CubicalComplex::periodic)
+    .def("coordinates", (std::vector<Integer>(CubicalComplex::*)(Integer)const)&CubicalComplex::coordinates)
     .def("barycenter", &CubicalComplex::barycenter)    
     .def("cell_type", &CubicalComplex::cell_type)
     .def("cell_shape", &CubicalComplex::cell_shape)
     .def("cell_pos", &CubicalComplex::cell_pos)
     .def("cell_dim", &CubicalComplex::cell_dim)
-    .def("cell_index", &CubicalComplex::cell_index)
+    .def("cell_index", (Integer(CubicalComplex::*)(std::vector<Integer> const&,Integer)const)&CubicalComplex::cell_index)
     .def("left", &CubicalComplex::left)
     .def("right", &CubicalComplex::right)
     .def("leftfringe", &CubicalComplex::leftfringe)
     .def("rightfringe", &CubicalComplex::rightfringe)
     .def("mincoords", &CubicalComplex::mincoords)
     .def("maxcoords", &CubicalComplex::maxcoords)
-    .def("parallelneighbors", &CubicalComplex::parallelneighbors);
+    .def("parallelneighbors", (std::vector<Integer>(CubicalComplex::*)(Integer)const)&CubicalComplex::parallelneighbors)
+    .def("coordinates_many", [](CubicalComplex const& X, IntegerArray cells) {
+       auto N = cells_size_(cells);
+       IntegerArray result(std::vector<py::ssize_t>{N, (py::ssize_t)X.dimension()});
+       Integer * out = result.mutable_data();
+       py::gil_scoped_release release;
+       X.coordinates_many(cells.data(), N, out);
+       return result;
+    })
+    .def("barycenter_many", [](CubicalComplex const& X, IntegerArray cells) {
+       auto N = cells_size_(cells);
+       IntegerArray result(std::vector<py::ssize_t>{N, (py::ssize_t)X.dimension()});
+       Integer * out = result.mutable_data();
+       py::gil_scoped_release release;
+       X.barycenter_many(cells.data(), N, out);
+       return result;
+    })
+    .def("cell_shape_many", [](CubicalComplex const& X, IntegerArray cells) {
+       auto N = cells_size_(cells);
+       IntegerArray result(N);
+       Integer * out = result.mutable_data();
+       py::gil_scoped_release release;
+       X.cell_shape_many(cells.data(), N, out);
+       return result;
+    })
+    .def("cell_dim_many", [](CubicalComplex const& X, IntegerArray cells) {
+       auto N = cells_size_(cells);
+       IntegerArray result(N);
+       Integer * out = result.mutable_data();
+       py::gil_scoped_release release;
+       X.cell_dim_many(cells.data(), N, out);
+       return result;
+    })
+    .def("cell_index_many", [](CubicalComplex const& X, IntegerArray coordinates, IntegerArray shapes) {
+       auto N = cells_size_(shapes);
+       if ( coordinates.ndim() != 2 || coordinates.shape(0) != N || coordinates.shape(1) != X.dimension() ) {
+         throw std::invalid_argument("cell_index_many: coordinates must have shape (len(shapes), dimension())");
+       }
+       IntegerArray result(N);
+       Integer * out = result.mutable_data();
+       py::gil_scoped_release release;
+       X.cell_index_many(coordinates.data(), shapes.data(), N, out);
+       return result;
+    })
+    .def("topstar_many", [](CubicalComplex const& X, IntegerArray cells) {
+       // Returns (offsets, topcells): the top star of cells[i] is
+       // topcells[offsets[i]:offsets[i+1]]
+       return ragged_many_(cells,
+         [&](Integer const* c, Integer N, Integer * counts){ X.topstar_count_many(c, N, counts); },
+         [&](Integer const* c, Integer N, Integer const* offsets, Integer * out){ X.topstar_many(c, N, offsets, out); });
+    })
+    .def("parallelneighbors_many", [](CubicalComplex const& X, IntegerArray cells) {
+       // Returns (offsets, neighbors): the parallel neighbors of cells[i] are
+       // neighbors[offsets[i]:offsets[i+1]]
+       return ragged_many_(cells,
+         [&](Integer const* c, Integer N, Integer * counts){ X.parallelneighbors_count_many(c, N, counts); },
+         [&](Integer const* c, Integer N, Integer const* offsets, Integer * out){ X.parallelneighbors_many(c, N, offsets, out); });
+    });
 }
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
 #include <unordered_set>
 #include <vector>
 
@@ -14,14 +15,18 @@
 #include "Complex.h"
 #include "GradedComplex.h"
 #include "MorseMatching.h"
+#include "CubicalComplex.h"
+#include "DualComplex.h"
+#include "Parallel.h"
+#include "Progress.h"
+#include "Instrumentation.h"
 
 class CubicalMorseMatching : public MorseMatching {
 public:
   /// CubicalMorseMatching
-  CubicalMorseMatching ( std::shared_ptr<CubicalComplex> complex_ptr ) : complex_(complex_ptr) {
-    type_size_ = complex_ -> type_size();
-    graded_complex_.reset(new GradedComplex(complex_, [](Integer i){return 0;}));
-  }
+  ///   Matching of an ungraded complex (i.e. with every cell graded 0)
+  CubicalMorseMatching ( std::shared_ptr<CubicalComplex> complex_ptr )
+    : CubicalMorseMatching(std::make_shared<GradedComplex>(complex_ptr, [](Integer){return 0;})) {}
 
   /// CubicalMorseMatching
   CubicalMorseMatching ( std::shared_ptr<GradedComplex> graded_complex_ptr ) : graded_complex_(graded_complex_ptr) {
@@ -29,22 +34,44 @@ public:
     if ( not complex_ ) {
       throw std::invalid_argument("CubicalMorseMatching must be constructed with a Cubical Complex");
     }
+    StageTimer timer ( "matching" );
     type_size_ = complex_ -> type_size();
+    periodic_ = complex_ -> periodic();
+    num_vertices_ = complex_ -> size(0);
     Integer D = complex_ -> dimension();
     Integer idx = 0;
     begin_.resize(D+2);
     for ( Integer d = 0; d <= D; ++ d) {
       begin_[d] = idx;
       for ( auto v : (*complex_)(d) ) { // TODO: skip fringe cells
-        if ( ! complex_ -> rightfringe(v) ) {
-          if ( mate(v) == v ) { 
-            reindex_.push_back({v,idx});
-            ++idx;
-          }
+        report_progress("matching", v, complex_ -> size());
+        if ( periodic_ && complex_ -> rightfringe(v) ) continue;
+        if ( mate(v) == v ) { 
+          reindex_.push_back({v,idx});
+          ++idx;
         }
       }
     }
     begin_[D+1] = idx;
+    Instrumentation::instance().add("matching cells", complex_ -> size());
+    Instrumentation::instance().add("critical cells", idx);
+  }
+
+  /// CubicalMorseMatching
+  ///   Restore a matching whose critical cells were previously computed
+  ///   (see Serialization.h)
+  CubicalMorseMatching ( std::shared_ptr<GradedComplex> graded_complex_ptr,
+                         BeginType begin,
+                         ReindexType reindex )
+                       : graded_complex_(graded_complex_ptr),
+                         begin_(std::move(begin)), reindex_(std::move(reindex)) {
+    complex_ = std::dynamic_pointer_cast<CubicalComplex>(graded_complex_->complex());
+    if ( not complex_ ) {
+      throw std::invalid_argument("CubicalMorseMatching must be constructed with a Cubical Complex");
+    }
+    type_size_ = complex_ -> type_size();
+    periodic_ = complex_ -> periodic();
+    num_vertices_ = complex_ -> size(0);
   }
 
   /// critical_cells
@@ -56,22 +83,53 @@ public:
   /// mate
   Integer
   mate ( Integer x ) const { 
+    if ( not periodic_ ) return acyclic_mate_(x);
     return mate_(x, complex_ -> dimension());
   }
 
   /// priority
+  ///   Grade-major, so that flows into lower grades are reduced last
+  ///   (same convention as GenericMorseMatching). Throws
+  ///   std::overflow_error if grade * positions does not fit in an Integer.
   Integer
   priority ( Integer x ) const { 
-    return type_size_ - x % type_size_;
+    if ( not periodic_ ) {
+      // position of the cell's lower corner among the vertices
+      Integer y [ 64 ];
+      complex_ -> coordinates(x, y);
+      Integer position = complex_ -> cell_index(y, 0);
+      return grade_major_(graded_complex_ -> value(x), num_vertices_, position);
+    }
+    return grade_major_(graded_complex_ -> value(x), (Integer) type_size_, x % (Integer) type_size_);
+  }
+
+  /// graded_complex
+  std::shared_ptr<GradedComplex>
+  graded_complex ( void ) const {
+    return graded_complex_;
   }
 
 private:
   uint64_t type_size_;
+  bool periodic_;
+  Integer num_vertices_;
   std::shared_ptr<GradedComplex> graded_complex_;
   std::shared_ptr<CubicalComplex> complex_;
   BeginType begin_;
   ReindexType reindex_;
 
+  /// grade_major_
+  ///   value * positions + positions - position, checked for overflow
+  static Integer
+  grade_major_ ( Integer value, Integer positions, Integer position ) {
+    Integer result;
+    if ( __builtin_mul_overflow(value, positions, &result) ||
+         __builtin_add_overflow(result, positions - position, &result) ) {
+      throw std::overflow_error("CubicalMorseMatching: grade too large for priority");
+    }
+    return result;
+  }
+
   // def mate(cell, D):
   // for d in range(0, D):
   //   if cell has extent in dimension d:
@@ -89,6 +147,30 @@ private:
   // Note: the reason for the "fringe" check preventing mating is that otherwise it is possible to 
   //       end up with a cycle 
   // TODO: Furnish a proof of correctness and complexity that this cannot produce cycles.
+  // Non-periodic mode: the same rule with no fringe to avoid. A cell and
+  // its candidate mate have the same coordinates (the face to the left, or
+  // the coface to the right), so the recursion only changes the shape.
+  Integer acyclic_mate_ ( Integer cell ) const {
+    Integer x [ 64 ];
+    complex_ -> coordinates(cell, x);
+    Integer shape = complex_ -> cell_shape(cell);
+    Integer mate_shape = acyclic_mate_shape_(x, shape, graded_complex_ -> value(cell), complex_ -> dimension());
+    return (mate_shape == shape) ? cell : complex_ -> cell_index(x, mate_shape);
+  }
+
+  Integer acyclic_mate_shape_ ( Integer const* x, Integer shape, Integer value, Integer D ) const {
+    for ( Integer d = 0, bit = 1; d < D; ++ d, bit <<= 1L ) {
+      // no coface to the right of the far right face
+      if ( not (shape & bit) && x[d] == complex_ -> boxes()[d] ) continue;
+      Integer proposed_shape = shape ^ bit;
+      if ( graded_complex_ -> value(complex_ -> cell_index(x, proposed_shape)) == value
+           && proposed_shape == acyclic_mate_shape_(x, proposed_shape, value, d) ) {
+        return proposed_shape;
+      }
+    }
+    return shape;
+  }
+
   Integer mate_ ( Integer cell, Integer D ) const {
     //bool fringe = complex_ -> rightfringe(cell);
     if ( complex_ -> rightfringe(cell) ) return cell; // MAYBE
@@ -104,6 +186,7 @@ private:
       //if ( bit & maxcoords ) continue; // Don't connect fringe to acyclic part
       Integer type_offset = complex_ -> type_size() * complex_ -> TS() [ shape ^ bit ];
       Integer proposed_mate = position + type_offset;
+      if ( complex_ -> rightfringe(proposed_mate) ) continue; // keep the matching symmetric
       if ( graded_complex_ -> value(proposed_mate) == graded_complex_ -> value(cell) && proposed_mate == mate_(proposed_mate, d) ) { 
         return proposed_mate;
       }
@@ -112,6 +195,85 @@ private:
   }
 };
 
+/// DualCubicalMorseMatching
+///   Matching of the dual of a non-periodic CubicalComplex, by way of the
+///   cubical matching of the primal complex. Dual cell i is primal cell
+///   N-1-i, and the primal is graded by the negated dual grading, so that
+///   the grading is still closed under faces. A matching is acyclic if
+///   and only if it is acyclic with every arrow reversed, so the reindexed
+///   primal matching is a Morse matching of the dual; as the flow also
+///   runs backwards, priorities are negated.
+///   (Periodic complexes are not handled: the periodic cubical matching
+///   leaves the fringe out, which does not dualize.)
+class DualCubicalMorseMatching : public MorseMatching {
+public:
+  /// DualCubicalMorseMatching
+  ///   Matching of an ungraded complex (i.e. with every cell graded 0)
+  DualCubicalMorseMatching ( std::shared_ptr<DualComplex> complex_ptr )
+    : DualCubicalMorseMatching(std::make_shared<GradedComplex>(complex_ptr, [](Integer){return 0;})) {}
+
+  /// DualCubicalMorseMatching
+  DualCubicalMorseMatching ( std::shared_ptr<GradedComplex> graded_complex_ptr ) : graded_complex_(graded_complex_ptr) {
+    auto dual = std::dynamic_pointer_cast<DualComplex>(graded_complex_ -> complex());
+    auto cubical = dual ? std::dynamic_pointer_cast<CubicalComplex>(dual -> base()) : nullptr;
+    if ( not cubical || cubical -> periodic() ) {
+      throw std::invalid_argument("DualCubicalMorseMatching must be constructed with the dual of a non-periodic Cubical Complex");
+    }
+    last_ = cubical -> size() - 1;
+    std::vector<Integer> values ( cubical -> size() );
+    parallel_for(0, cubical -> size(), [&](Integer x){ values[x] = - graded_complex_ -> value(last_ - x); });
+    primal_ = std::make_shared<CubicalMorseMatching>(std::make_shared<GradedComplex>(cubical, std::move(values)));
+    // Critical cells: the primal ones in reverse, so dimension D-d of the
+    // primal becomes dimension d
+    auto critical = primal_ -> critical_cells();
+    Integer D = cubical -> dimension();
+    Integer P = critical.first[D+1];
+    begin_.resize(D+2);
+    for ( Integer d = 0; d <= D+1; ++ d ) begin_[d] = P - critical.first[D+1-d];
+    reindex_.resize(P);
+    for ( Integer j = 0; j < P; ++ j ) reindex_[j] = {last_ - critical.second[P-1-j].first, j};
+  }
+
+  /// critical_cells
+  std::pair<BeginType const&,ReindexType const&>
+  critical_cells ( void ) const {
+    return {begin_,reindex_};
+  }
+
+  /// mate
+  Integer
+  mate ( Integer x ) const {
+    return last_ - primal_ -> mate(last_ - x);
+  }
+
+  /// priority
+  ///   Negated primal priority of the pair
+  Integer
+  priority ( Integer x ) const {
+    return - primal_ -> priority(primal_ -> mate(last_ - x));
+  }
+
+  /// graded_complex
+  std::shared_ptr<GradedComplex>
+  graded_complex ( void ) const {
+    return graded_complex_;
+  }
+
+  /// primal
+  ///   The matching of the primal complex
+  std::shared_ptr<CubicalMorseMatching>
+  primal ( void ) const {
+    return primal_;
+  }
+
+private:
+  Integer last_;
+  std::shared_ptr<GradedComplex> graded_complex_;
+  std::shared_ptr<CubicalMorseMatching> primal_;
+  BeginType begin_;
+  ReindexType reindex_;
+};
+
 /// Python Bindings
 
 #include <pybind11/pybind11.h>
@@ -120,9 +282,14 @@ namespace py = pybind11;
 
 inline void
 CubicalMorseMatchingBinding(py::module &m) {
-  py::class_<CubicalMorseMatching, std::shared_ptr<CubicalMorseMatching>>(m, "CubicalMorseMatching")
+  py::class_<CubicalMorseMatching, std::shared_ptr<CubicalMorseMatching>, MorseMatching>(m, "CubicalMorseMatching")
     .def(py::init<std::shared_ptr<CubicalComplex>>())
     .def(py::init<std::shared_ptr<GradedComplex>>())    
     .def("mate", &CubicalMorseMatching::mate)
     .def("priority", &CubicalMorseMatching::priority);
+  py::class_<DualCubicalMorseMatching, std::shared_ptr<DualCubicalMorseMatching>, MorseMatching>(m, "DualCubicalMorseMatching")
+    .def(py::init<std::shared_ptr<DualComplex>>())
+    .def(py::init<std::shared_ptr<GradedComplex>>())
+    .def("mate", &DualCubicalMorseMatching::mate)
+    .def("priority", &DualCubicalMorseMatching::priority);
 }
@@ -0,0 +1,297 @@
+/// CubicalSetComplex.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include "Integer.h"
+#include "Iterator.h"
+#include "Chain.h"
+#include "Complex.h"
+#include "CubicalComplex.h"
+#include "Parallel.h"
+#include "Instrumentation.h"
+
+/// CubicalSetComplex
+///   The closure of a set of top cells of a cubical grid.
+///   Only cells of the closure are indexed, so memory and time scale with
+///   the number of occupied cells rather than with the bounding box.
+///   Cells are numbered by their rank among the indices of the closure in
+///   the ambient CubicalComplex, which is the grid padded with one box on
+///   the right in every dimension (so closures never wrap around).
+///   Since ambient indices are ordered by shape type, this numbering is
+///   ordered by dimension, as Complex requires.
+class CubicalSetComplex : public Complex {
+public:
+  /// CubicalSetComplex
+  ///   Default constructor
+  CubicalSetComplex ( void ) {}
+
+  /// CubicalSetComplex
+  ///   Closure of the top cells with the given coordinates
+  ///   (coordinates[i*D+d] is coordinate d of top cell i) in a grid which
+  ///   is boxes[d] boxes across in dimension d
+  CubicalSetComplex ( std::vector<Integer> const& boxes,
+                      Integer const* coordinates,
+                      Integer N ) {
+    assign ( boxes, coordinates, N );
+  }
+
+  /// CubicalSetComplex
+  ///   Closure of the top cells with the given coordinates
+  CubicalSetComplex ( std::vector<Integer> const& boxes,
+                      std::vector<std::vector<Integer>> const& top_cells ) {
+    Integer D = boxes.size();
+    std::vector<Integer> coordinates;
+    coordinates.reserve(D * top_cells.size());
+    for ( auto const& x : top_cells ) {
+      if ( (Integer) x.size() != D ) {
+        throw std::invalid_argument("CubicalSetComplex: top cell coordinates have wrong dimension");
+      }
+      coordinates.insert(coordinates.end(), x.begin(), x.end());
+    }
+    assign ( boxes, coordinates.data(), top_cells.size() );
+  }
+
+  /// CubicalSetComplex
+  ///   Closure of the top cells marked in a bitmap of prod(boxes) entries,
+  ///   with the first coordinate varying fastest
+  CubicalSetComplex ( std::vector<Integer> const& boxes,
+                      bool const* bitmap ) {
+    Integer D = boxes.size();
+    Integer L = std::accumulate(boxes.begin(), boxes.end(), (Integer)1, std::multiplies<Integer>());
+    std::vector<Integer> coordinates;
+    for ( Integer i = 0; i < L; ++ i ) {
+      if ( not bitmap[i] ) continue;
+      Integer k = i;
+      for ( Integer d = 0; d < D; ++ d ) {
+        coordinates.push_back(k % boxes[d]);
+        k /= boxes[d];
+      }
+    }
+    assign ( boxes, coordinates.data(), coordinates.size() / std::max<Integer>(D, 1) );
+  }
+
+  /// assign
+  void
+  assign ( std::vector<Integer> const& boxes,
+           Integer const* coordinates,
+           Integer N ) {
+    StageTimer timer ( "cubical set closure" );
+    Integer D = boxes.size();
+    boxes_ = boxes;
+    std::vector<Integer> padded ( boxes );
+    for ( auto & b : padded ) b += 1;
+    ambient_ = std::make_shared<CubicalComplex>(padded);
+    dim_ = D;
+
+    auto const& X = *ambient_;
+    Integer L = X.type_size();
+    Integer M = 1L << D;
+
+    // Top cells
+    std::vector<Integer> level ( N );
+    Integer top_offset = L * X.TS()[M-1];
+    parallel_for(0, N, [&](Integer i){
+      Integer position = 0;
+      for ( Integer d = D - 1; d >= 0; -- d ) {
+        Integer x = coordinates[i*D+d];
+        if ( x < 0 || x >= boxes_[d] ) {
+          throw std::invalid_argument("CubicalSetComplex: coordinate out of range");
+        }
+        position = position * padded[d] + x;
+      }
+      level[i] = top_offset + position;
+    });
+    std::sort(level.begin(), level.end());
+    level.erase(std::unique(level.begin(), level.end()), level.end());
+
+    // Closure, one dimension at a time: the faces of the k-cells are the
+    // sorted, deduplicated boundaries of the (k+1)-cells
+    std::vector<std::vector<Integer>> levels ( D + 1 );
+    levels[D] = std::move(level);
+    for ( Integer k = D - 1; k >= 0; -- k ) {
+      auto const& cofaces = levels[k+1];
+      Integer F = 2 * (k + 1);
+      std::vector<Integer> faces ( F * cofaces.size() );
+      parallel_for(0, cofaces.size(), [&](Integer i){
+        Integer * out = faces.data() + F * i;
+        X.column(cofaces[i], [&](Integer y){ *out++ = y; });
+      });
+      std::sort(faces.begin(), faces.end());
+      faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+      levels[k] = std::move(faces);
+    }
+
+    cells_.clear();
+    begin_.assign(D + 2, Iterator(0));
+    for ( Integer k = 0; k <= D; ++ k ) {
+      begin_[k] = Iterator(cells_.size());
+      cells_.insert(cells_.end(), levels[k].begin(), levels[k].end());
+      std::vector<Integer>().swap(levels[k]);
+    }
+    begin_[D+1] = Iterator(cells_.size());
+
+    // Rank directory: cells of ambient type t are cells_[type_begin_[t] .. type_begin_[t+1])
+    type_begin_.assign(M + 1, 0);
+    for ( auto x : cells_ ) ++ type_begin_[X.cell_type(x) + 1];
+    std::partial_sum(type_begin_.begin(), type_begin_.end(), type_begin_.begin());
+  }
+
+  /// column
+  virtual void
+  column ( Integer i, std::function<void(Integer)> const& callback ) const final {
+    ambient_ -> column(cells_[i], [&](Integer y){ callback(rank_(y)); });
+  }
+
+  /// row
+  virtual void
+  row ( Integer i, std::function<void(Integer)> const& callback ) const final {
+    ambient_ -> row(cells_[i], [&](Integer y){
+      Integer j = rank_(y);
+      if ( j != -1 ) callback(j);
+    });
+  }
+
+  /// topstar
+  ///   return top dimensional cells in star
+  virtual std::vector<Integer>
+  topstar ( Integer i ) const final {
+    std::vector<Integer> result;
+    ambient_ -> topstar(cells_[i], [&](Integer y){
+      Integer j = rank_(y);
+      if ( j != -1 ) result.push_back(j);
+    });
+    return result;
+  }
+
+  /// ambient
+  ///   The (padded) CubicalComplex the cells are taken from
+  std::shared_ptr<CubicalComplex>
+  ambient ( void ) const {
+    return ambient_;
+  }
+
+  /// boxes
+  ///   Number of boxes across in each dimension (without padding)
+  std::vector<Integer> const&
+  boxes ( void ) const {
+    return boxes_;
+  }
+
+  /// ambient_cell
+  ///   Index in the ambient complex of cell i
+  Integer
+  ambient_cell ( Integer i ) const {
+    return cells_[i];
+  }
+
+  /// index
+  ///   Cell with the given ambient index, or -1 if it is not in the complex
+  Integer
+  index ( Integer ambient_cell ) const {
+    if ( ambient_cell < 0 || ambient_cell >= ambient_ -> size() ) return -1;
+    return rank_(ambient_cell);
+  }
+
+  /// cell_index
+  ///   Cell with the given coordinates and shape, or -1 if not in the complex
+  Integer
+  cell_index ( std::vector<Integer> const& coordinates, Integer shape ) const {
+    if ( (Integer) coordinates.size() != dimension() || shape < 0 || shape >= (1L << dimension()) ) return -1;
+    for ( Integer d = 0; d < dimension(); ++ d ) {
+      if ( coordinates[d] < 0 || coordinates[d] > boxes_[d] ) return -1;
+    }
+    return index(ambient_ -> cell_index(coordinates, shape));
+  }
+
+  /// coordinates
+  std::vector<Integer>
+  coordinates ( Integer i ) const {
+    return ambient_ -> coordinates(cells_[i]);
+  }
+
+  /// barycenter
+  std::vector<Integer>
+  barycenter ( Integer i ) const {
+    return ambient_ -> barycenter(cells_[i]);
+  }
+
+  /// cell_shape
+  Integer
+  cell_shape ( Integer i ) const {
+    return ambient_ -> cell_shape(cells_[i]);
+  }
+
+  /// cell_dim
+  Integer
+  cell_dim ( Integer i ) const {
+    return ambient_ -> cell_dim(cells_[i]);
+  }
+
+  /// memory
+  ///   Bytes used by the cell index
+  Integer
+  memory ( void ) const {
+    return sizeof(Integer) * (cells_.size() + type_begin_.size());
+  }
+
+private:
+  /// rank_
+  ///   Cell with the given ambient index, or -1. Binary search within the
+  ///   cells of the same ambient type.
+  Integer
+  rank_ ( Integer ambient_cell ) const {
+    Integer t = ambient_cell / ambient_ -> type_size();
+    auto first = cells_.begin() + type_begin_[t];
+    auto last = cells_.begin() + type_begin_[t+1];
+    auto it = std::lower_bound(first, last, ambient_cell);
+    if ( it == last || *it != ambient_cell ) return -1;
+    return it - cells_.begin();
+  }
+
+  std::shared_ptr<CubicalComplex> ambient_;
+  std::vector<Integer> boxes_;
+  std::vector<Integer> cells_;
+  std::vector<Integer> type_begin_;
+};
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+namespace py = pybind11;
+
+inline void
+CubicalSetComplexBinding(py::module &m) {
+  py::class_<CubicalSetComplex, std::shared_ptr<CubicalSetComplex>, Complex>(m, "CubicalSetComplex")
+    .def(py::init([](std::vector<Integer> const& boxes, IntegerArray top_cells) {
+       // top_cells : N x D array of coordinates of occupied top cells
+       Integer D = boxes.size();
+       if ( top_cells.ndim() != 2 || top_cells.shape(1) != D ) {
+         throw std::invalid_argument("CubicalSetComplex: top cells must have shape (N, len(boxes))");
+       }
+       py::gil_scoped_release release;
+       return std::make_shared<CubicalSetComplex>(boxes, top_cells.data(), top_cells.shape(0));
+    }))
+    .def(py::init([](py::array_t<bool, py::array::f_style | py::array::forcecast> bitmap) {
+       // bitmap[x_0, ..., x_{D-1}] is true for occupied top cells
+       std::vector<Integer> boxes ( bitmap.shape(), bitmap.shape() + bitmap.ndim() );
+       py::gil_scoped_release release;
+       return std::make_shared<CubicalSetComplex>(boxes, bitmap.data());
+    }))
+    .def("ambient", &CubicalSetComplex::ambient)
+    .def("boxes", &CubicalSetComplex::boxes)
+    .def("ambient_cell", &CubicalSetComplex::ambient_cell)
+    .def("index", &CubicalSetComplex::index)
+    .def("cell_index", &CubicalSetComplex::cell_index)
+    .def("coordinates", &CubicalSetComplex::coordinates)
+    .def("barycenter", &CubicalSetComplex::barycenter)
+    .def("cell_shape", &CubicalSetComplex::cell_shape)
+    .def("cell_dim", &CubicalSetComplex::cell_dim)
+    .def("memory", &CubicalSetComplex::memory);
+}
@@ -0,0 +1,216 @@
+/// DenseZ2.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "Integer.h"
+#include "Parallel.h"
+
+/// dense_z2_limit
+///   Largest block (rows times padded columns, in bits) which is reduced
+///   with the dense kernels below instead of sparse chains; 0 disables
+///   them. Defaults to 2^28 bits (32 MiB).
+inline std::atomic<Integer> &
+dense_z2_limit_ ( void ) {
+  static std::atomic<Integer> limit ( 1L << 28 );
+  return limit;
+}
+
+inline Integer
+dense_z2_limit ( void ) {
+  return dense_z2_limit_ ();
+}
+
+inline void
+set_dense_z2_limit ( Integer bits ) {
+  dense_z2_limit_ () = std::max<Integer>(0, bits);
+}
+
+/// dense_z2_fits
+///   True if a rows x cols block is to be reduced densely, counting the
+///   bits of the rows as stored by BitMatrix (padded to 256 bits)
+inline bool
+dense_z2_fits ( Integer rows, Integer cols ) {
+  Integer limit = dense_z2_limit ();
+  Integer bits = ((cols + 255) / 256) * 256;
+  return limit > 0 && ( bits == 0 || rows <= limit / bits );
+}
+
+/// BitMatrix
+///   Dense matrix over Z/2Z. Rows are packed into 64-bit words, padded
+///   to a multiple of four words so that whole-row sums are plain loops
+///   of word XORs which the compiler vectorizes (256 bits at a time on
+///   AVX2).
+class BitMatrix {
+public:
+  /// BitMatrix
+  ///   rows x cols zero matrix
+  BitMatrix ( Integer rows, Integer cols )
+            : rows_(rows), cols_(cols), words_(((cols + 255) / 256) * 4),
+              data_(rows * words_, 0) {}
+
+  /// rows
+  Integer
+  rows ( void ) const {
+    return rows_;
+  }
+
+  /// cols
+  Integer
+  cols ( void ) const {
+    return cols_;
+  }
+
+  /// words
+  ///   Number of 64-bit words per row
+  Integer
+  words ( void ) const {
+    return words_;
+  }
+
+  /// row
+  uint64_t *
+  row ( Integer i ) {
+    return data_.data() + i * words_;
+  }
+
+  /// row
+  uint64_t const*
+  row ( Integer i ) const {
+    return data_.data() + i * words_;
+  }
+
+  /// get
+  bool
+  get ( Integer i, Integer j ) const {
+    return (row(i)[j >> 6] >> (j & 63)) & 1;
+  }
+
+  /// flip
+  void
+  flip ( Integer i, Integer j ) {
+    row(i)[j >> 6] ^= uint64_t(1) << (j & 63);
+  }
+
+  /// for_each
+  ///   Call f(j) on the columns j of the nonzero entries of row i, in order
+  template < typename F >
+  void
+  for_each ( Integer i, F const& f ) const {
+    uint64_t const* r = row(i);
+    for ( Integer w = 0; w < words_; ++ w ) {
+      for ( uint64_t bits = r[w]; bits; bits &= bits - 1 ) f(w * 64 + __builtin_ctzll(bits));
+    }
+  }
+
+  /// rank
+  ///   Rank of the matrix, by the method of four Russians: columns are
+  ///   taken eight at a time; the (up to eight) pivot rows for them are
+  ///   found and reduced against one another, every sum of them is
+  ///   tabulated, and each remaining row is then cleared in those columns
+  ///   by adding a single table entry, in parallel over the rows
+  Integer
+  rank ( void ) const {
+    BitMatrix A ( *this );
+    return A.eliminate_();
+  }
+
+private:
+  Integer rows_;
+  Integer cols_;
+  Integer words_;
+  std::vector<uint64_t> data_;
+
+  /// strip_
+  ///   The eight bits of row i in columns c, ..., c+7 (c a multiple of 8)
+  uint8_t
+  strip_ ( Integer i, Integer c ) const {
+    return row(i)[c >> 6] >> (c & 63);
+  }
+
+  /// add_row_
+  ///   row i += row k, from word w on
+  void
+  add_row_ ( Integer i, Integer k, Integer w ) {
+    uint64_t * target = row(i);
+    uint64_t const* source = row(k);
+    for ( Integer x = w; x < words_; ++ x ) target[x] ^= source[x];
+  }
+
+  /// eliminate_
+  ///   Bring the matrix to row echelon form (see rank), returning the
+  ///   number of pivots
+  Integer
+  eliminate_ ( void ) {
+    Integer rank = 0;
+    std::vector<uint64_t> table ( 256 * words_ );
+    for ( Integer c = 0; c < cols_ && rank < rows_; c += 8 ) {
+      Integer w = c >> 6;
+      // pivots: row rank+t has its pivot in column c + column[t]; the
+      // strip bits of the others are reduced on the fly to find them
+      Integer column [ 8 ];
+      Integer pivots = 0;
+      for ( Integer i = rank; i < rows_ && pivots < 8; ++ i ) {
+        uint8_t bits = strip_(i, c);
+        for ( Integer t = 0; t < pivots; ++ t ) {
+          if ( (bits >> column[t]) & 1 ) bits ^= strip_(rank + t, c);
+        }
+        if ( bits == 0 ) continue;
+        // a new pivot: reduce it, then clear its column from the others
+        if ( i != rank + pivots ) {
+          std::swap_ranges(row(i), row(i) + words_, row(rank + pivots));
+        }
+        Integer p = rank + pivots;
+        for ( Integer t = 0; t < pivots; ++ t ) {
+          if ( (strip_(p, c) >> column[t]) & 1 ) add_row_(p, rank + t, w);
+        }
+        column[pivots] = __builtin_ctz(strip_(p, c));
+        for ( Integer t = 0; t < pivots; ++ t ) {
+          if ( (strip_(rank + t, c) >> column[pivots]) & 1 ) add_row_(rank + t, p, w);
+        }
+        ++ pivots;
+      }
+      if ( pivots == 0 ) continue;
+      // table[s] is the sum of the pivot rows t in the subset s
+      Integer subsets = 1L << pivots;
+      std::fill(table.begin(), table.begin() + words_, 0);
+      for ( Integer s = 1; s < subsets; ++ s ) {
+        uint64_t * entry = table.data() + s * words_;
+        uint64_t const* rest = table.data() + (s & (s - 1)) * words_;
+        uint64_t const* pivot = row(rank + __builtin_ctzll(s));
+        for ( Integer x = w; x < words_; ++ x ) entry[x] = rest[x] ^ pivot[x];
+      }
+      parallel_for(rank + pivots, rows_, [&](Integer i){
+        uint8_t bits = strip_(i, c);
+        Integer s = 0;
+        for ( Integer t = 0; t < pivots; ++ t ) s |= ((bits >> column[t]) & 1) << t;
+        if ( s == 0 ) return;
+        uint64_t * target = row(i);
+        uint64_t const* entry = table.data() + s * words_;
+        for ( Integer x = w; x < words_; ++ x ) target[x] ^= entry[x];
+      }, std::max<Integer>(1, 65536 / words_));
+      rank += pivots;
+    }
+    return rank;
+  }
+};
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+namespace py = pybind11;
+
+inline void
+DenseZ2Binding(py::module &m) {
+  m.def("dense_z2_limit", &dense_z2_limit);
+  m.def("set_dense_z2_limit", &set_dense_z2_limit);
+}
@@ -8,12 +8,17 @@
 #include "common.h"
 
 #include "Complex.h"
+#include "CubicalComplex.h"
 
 /// DualComplex
+///   Cell x of the dual is cell size()-1-x of c, with boundary and
+///   coboundary swapped. The dual of a CubicalComplex calls its
+///   boundary and coboundary directly rather than through std::function.
 class DualComplex : public Complex {
 public:
 
   DualComplex( std::shared_ptr<Complex> c ) : c_(c) {
+    cubical_ = dynamic_cast<CubicalComplex const*>(c_.get());
     dim_ = c_ -> dimension();
     begin_.resize(dim_+2);
     Integer cumulative = 0;
@@ -36,8 +41,10 @@ public:
   ///   boundary matrix
   virtual void
   column ( Integer i, std::function<void(Integer)> const& callback) const final {
-    auto transformed = [&](Integer x){ callback(size() - x - 1); };
-    c_ -> row(size() - i - 1, transformed );
+    Integer last = size() - 1;
+    auto transformed = [&](Integer x){ callback(last - x); };
+    if ( cubical_ ) return cubical_ -> row(last - i, transformed);
+    c_ -> row(last - i, transformed );
   }
 
   /// row
@@ -45,12 +52,22 @@ public:
   ///   boundary matrix
   virtual void
   row ( Integer i, std::function<void(Integer)> const& callback) const final {
-    auto transformed = [&](Integer x){ callback(size() - x - 1); };
-    c_ -> column(size() - i - 1, transformed );
+    Integer last = size() - 1;
+    auto transformed = [&](Integer x){ callback(last - x); };
+    if ( cubical_ ) return cubical_ -> column(last - i, transformed);
+    c_ -> column(last - i, transformed );
+  }
+
+  /// base
+  ///   The complex this is the dual of
+  std::shared_ptr<Complex>
+  base ( void ) const {
+    return c_;
   }
 
 protected:
   std::shared_ptr<Complex> c_;
+  CubicalComplex const* cubical_;
 };
 
 /// Python Bindings
@@ -63,5 +80,6 @@ inline void
 DualComplexBinding(py::module &m) {
   py::class_<DualComplex, std::shared_ptr<DualComplex>, Complex>(m, "DualComplex")
     .def(py::init<std::shared_ptr<Complex>>())
-    .def("dual",&DualComplex::dual);
+    .def("dual",&DualComplex::dual)
+    .def("base",&DualComplex::base);
 }
@@ -0,0 +1,224 @@
+/// FlagComplex.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <cmath>
+#include <mutex>
+
+#include "Integer.h"
+#include "IndexArray.h"
+#include "Parallel.h"
+#include "SimplicialComplex.h"
+#include "GradedComplex.h"
+
+/// FlagCliques_
+///   Depth-first enumeration of the cliques of at most K vertices whose
+///   least vertex is given, in lexicographic order. neighbors holds one
+///   bitset of W words per vertex u, with bit w set for the neighbors
+///   w > u of u, so a clique is extended by the set bits of the
+///   intersection of its vertices' bitsets.
+template < typename Distance >
+class FlagCliques_ {
+public:
+  FlagCliques_ ( Distance const& distance, std::vector<uint64_t> const& neighbors,
+                 Integer W, Integer K, std::vector<double> const& levels )
+    : distance_(distance), neighbors_(neighbors), W_(W), K_(K), levels_(levels),
+      candidates_(K * W), clique_(K), grade_(K), faces_(K), grades_(K) {}
+
+  /// operator ()
+  ///   Append the cliques with least vertex u to faces(d) and grades(d)
+  void
+  operator () ( Integer u ) {
+    clique_[0] = u;
+    grade_[0] = 0;
+    emit_(0);
+    if ( K_ == 1 ) return;
+    std::copy(neighbors_.begin() + u*W_, neighbors_.begin() + (u+1)*W_, candidates_.begin());
+    extend_(1, u >> 6);
+  }
+
+  /// faces
+  ///   Vertices of the d-simplices found so far, d+1 per simplex
+  std::vector<Integer> &
+  faces ( Integer d ) {
+    return faces_[d];
+  }
+
+  /// grades
+  ///   Grades of the d-simplices found so far
+  std::vector<Integer> &
+  grades ( Integer d ) {
+    return grades_[d];
+  }
+
+private:
+  Distance const& distance_;
+  std::vector<uint64_t> const& neighbors_;
+  Integer W_;
+  Integer K_;
+  std::vector<double> const& levels_;
+  std::vector<uint64_t> candidates_;
+  std::vector<Integer> clique_;
+  std::vector<Integer> grade_;
+  std::vector<std::vector<Integer>> faces_;
+  std::vector<std::vector<Integer>> grades_;
+
+  /// emit_
+  void
+  emit_ ( Integer k ) {
+    faces_[k].insert(faces_[k].end(), clique_.begin(), clique_.begin() + k + 1);
+    grades_[k].push_back(grade_[k]);
+  }
+
+  /// extend_
+  ///   Extend the k-vertex clique by each candidate in turn; candidates
+  ///   all lie in words first, ..., W-1
+  void
+  extend_ ( Integer k, Integer first ) {
+    uint64_t const* candidates = candidates_.data() + (k-1)*W_;
+    for ( Integer word = first; word < W_; ++ word ) {
+      for ( uint64_t bits = candidates[word]; bits; bits &= bits - 1 ) {
+        Integer w = word * 64 + __builtin_ctzll(bits);
+        // the grade is the position of the longest edge among the levels
+        Integer g = grade_[k-1];
+        for ( Integer i = 0; i < k; ++ i ) {
+          double d = distance_(clique_[i], w);
+          g = std::max<Integer>(g, std::lower_bound(levels_.begin() + 1, levels_.end(), d) - levels_.begin());
+        }
+        clique_[k] = w;
+        grade_[k] = g;
+        emit_(k);
+        if ( k + 1 == K_ ) continue;
+        uint64_t * next = candidates_.data() + k*W_;
+        uint64_t const* adjacent = neighbors_.data() + w*W_;
+        bool any = false;
+        for ( Integer t = w >> 6; t < W_; ++ t ) {
+          next[t] = candidates[t] & adjacent[t];
+          any = any || next[t];
+        }
+        if ( any ) extend_(k+1, w >> 6);
+      }
+    }
+  }
+};
+
+/// FlagComplex
+///   Vietoris-Rips complex of the points 0, ..., n-1 with the given
+///   (symmetric) distance: the simplices are the cliques, of at most
+///   max_dimension+1 vertices, of the graph joining points at distance
+///   at most radius. It is graded by filtration index: a simplex has the
+///   grade g for which levels[g] is its diameter, where on return levels
+///   holds 0 followed by the distinct edge lengths in increasing order.
+///   So vertices have grade 0 and the simplices of grade at most g form
+///   the complex at radius levels[g].
+///   Neighborhoods are bitsets (n^2/8 bytes). Cliques are enumerated in
+///   parallel, each block of least vertices in lexicographic order, so
+///   the simplices come out sorted and are never looked up or sorted.
+template < typename Distance >
+std::shared_ptr<GradedComplex>
+FlagComplex ( Integer n, Distance const& distance, double radius,
+              Integer max_dimension, std::vector<double> & levels ) {
+  if ( max_dimension < 0 ) {
+    throw std::invalid_argument("FlagComplex: max_dimension must be nonnegative");
+  }
+  Integer W = (n + 63) / 64;
+  Integer K = max_dimension + 1;
+  std::vector<uint64_t> neighbors ( K > 1 ? n * W : 0, 0 );
+  levels.assign(1, 0.0);
+  if ( K > 1 ) {
+    std::mutex mutex;
+    parallel_for_blocks(0, n, [&](Integer b, Integer e){
+      std::vector<double> lengths;
+      for ( Integer u = b; u < e; ++ u ) {
+        for ( Integer w = u + 1; w < n; ++ w ) {
+          double d = distance(u, w);
+          if ( not (d <= radius) ) continue;
+          neighbors[u*W + (w >> 6)] |= uint64_t(1) << (w & 63);
+          lengths.push_back(d);
+        }
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      levels.insert(levels.end(), lengths.begin(), lengths.end());
+    }, 64);
+    parallel_sort(levels.begin() + 1, levels.end(), std::less<double>());
+    levels.erase(std::unique(levels.begin() + 1, levels.end()), levels.end());
+  }
+  // Blocks of least vertices, several per thread since low vertices
+  // have more neighbors above them
+  Integer B = std::min<Integer>(n, 8 * num_threads());
+  std::vector<std::unique_ptr<FlagCliques_<Distance>>> blocks ( B );
+  parallel_for_blocks(0, B, [&](Integer bb, Integer be){
+    for ( Integer t = bb; t < be; ++ t ) {
+      blocks[t].reset(new FlagCliques_<Distance>(distance, neighbors, W, K, levels));
+      for ( Integer u = (n * t) / B; u < (n * (t+1)) / B; ++ u ) (*blocks[t])(u);
+    }
+  }, 1);
+  std::vector<uint64_t>().swap(neighbors);
+  // Concatenate the blocks; each dimension is already in lexicographic order
+  std::vector<IndexArray> vertices;
+  std::vector<Integer> values;
+  for ( Integer d = 0; d < K; ++ d ) {
+    Integer count = 0;
+    for ( auto const& block : blocks ) count += block -> grades(d).size();
+    if ( count == 0 ) break;
+    IndexArray v ( count * (d+1), 0, n );
+    Integer k = 0;
+    for ( auto & block : blocks ) {
+      for ( auto x : block -> faces(d) ) v.set(k++, x);
+      values.insert(values.end(), block -> grades(d).begin(), block -> grades(d).end());
+      std::vector<Integer>().swap(block -> faces(d));
+      std::vector<Integer>().swap(block -> grades(d));
+    }
+    vertices.push_back(std::move(v));
+  }
+  auto complex = std::make_shared<SimplicialComplex>(std::move(vertices));
+  return std::make_shared<GradedComplex>(complex, std::move(values));
+}
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+namespace py = pybind11;
+
+inline void
+FlagComplexBinding(py::module &m) {
+  m.def("FlagComplex", [](py::array_t<double, py::array::c_style | py::array::forcecast> data,
+                          double radius, Integer max_dimension, bool distance_matrix) {
+    // data : n x m array of points (Euclidean distance), or with
+    // distance_matrix=True an n x n array of distances (upper triangle used).
+    // Returns (graded complex, levels); see FlagComplex.h
+    if ( data.ndim() != 2 || (distance_matrix && data.shape(0) != data.shape(1)) ) {
+      throw std::invalid_argument("FlagComplex: need an n x m array of points or an n x n distance matrix");
+    }
+    Integer n = data.shape(0), m = data.shape(1);
+    double const* x = data.data();
+    std::vector<double> levels;
+    std::shared_ptr<GradedComplex> result;
+    {
+      py::gil_scoped_release release;
+      if ( distance_matrix ) {
+        auto distance = [&](Integer u, Integer w){ return u < w ? x[u*n + w] : x[w*n + u]; };
+        result = FlagComplex(n, distance, radius, max_dimension, levels);
+      } else {
+        auto distance = [&](Integer u, Integer w){
+          double s = 0.0;
+          for ( Integer i = 0; i < m; ++ i ) {
+            double t = x[u*m + i] - x[w*m + i];
+            s += t * t;
+          }
+          return std::sqrt(s);
+        };
+        result = FlagComplex(n, distance, radius, max_dimension, levels);
+      }
+    }
+    return py::make_tuple(result, levels);
+  }, py::arg("points"), py::arg("radius"), py::arg("max_dimension") = 2,
+     py::arg("distance_matrix") = false);
+}
@@ -0,0 +1,240 @@
+/// FlowGraph.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Integer.h"
+#include "CompressedChains.h"
+#include "CubicalComplex.h"
+#include "Parallel.h"
+#include "Instrumentation.h"
+
+/// cubical_vertices
+///   Call f on each vertex of a cell of a cubical complex (wrapping
+///   around as in CubicalComplex::column in periodic mode)
+template < typename F >
+void
+cubical_vertices ( CubicalComplex const& X, Integer cell, F const& f ) {
+  Integer D = X.dimension();
+  Integer shape = X.cell_shape(cell);
+  if ( X.periodic() ) {
+    Integer L = X.type_size();
+    Integer position = cell % L;
+    for ( Integer e = 0; e < (1L << D); ++ e ) {
+      if ( e & ~shape ) continue;
+      Integer v = position;
+      for ( Integer d = 0; d < D; ++ d ) if ( (e >> d) & 1 ) v += X.PV()[d];
+      f(v % L);
+    }
+    return;
+  }
+  Integer x [ 64 ], y [ 64 ];
+  X.coordinates(cell, x);
+  for ( Integer e = 0; e < (1L << D); ++ e ) {
+    if ( e & ~shape ) continue;
+    for ( Integer d = 0; d < D; ++ d ) y[d] = x[d] + ((e >> d) & 1);
+    f(X.cell_index(y, 0));
+  }
+}
+
+/// FlowGraph
+///   Outer approximation of a flow on a cubical complex by a graph on its
+///   top cells: each wall (cell of dimension D-1) between two top cells
+///   lets the flow across in one direction or in both, and the graph has
+///   an edge from each top cell to each neighbor the flow may reach across
+///   their common wall. Rows are numbered by top cell position (cell minus
+///   the first top cell); targets are top cells, in increasing order.
+///   In periodic mode neighbors wrap around as in CubicalComplex::column.
+class FlowGraph {
+public:
+  /// FlowGraph
+  ///   wall_sign(w) is +1 if the flow crosses wall w only in the direction
+  ///   of increasing coordinate, -1 if only decreasing, and 0 if either.
+  ///   Signs are computed in parallel over the walls, then the rows in
+  ///   parallel over the top cells.
+  template < typename WallSign >
+  FlowGraph ( std::shared_ptr<CubicalComplex> complex, WallSign const& wall_sign ) : complex_(complex) {
+    StageTimer timer ( "flow graph" );
+    CubicalComplex const& X = *complex_;
+    Integer D = X.dimension();
+    if ( D == 0 ) throw std::invalid_argument("FlowGraph: complex has no walls");
+    Integer wall_begin = *X(D-1).begin();
+    Integer W = X.size(D-1);
+    std::vector<int8_t> signs ( W );
+    parallel_for(0, W, [&](Integer w){ signs[w] = wall_sign(wall_begin + w); });
+    top_begin_ = *X(D).begin();
+    Integer T = X.size(D);
+    // targets of row p, written to out (if given); counted once and then
+    // filled, since both neighbors along a dimension of two boxes may be
+    // the same top cell in periodic mode
+    auto row = [&](Integer p, Integer * out){
+      Integer neighbors [ 128 ];
+      Integer count = 0;
+      neighbors_(top_begin_ + p, [&](Integer wall, Integer neighbor, bool right){
+        Integer sign = signs[wall - wall_begin];
+        if ( right ? sign >= 0 : sign <= 0 ) neighbors[count++] = neighbor;
+      });
+      std::sort(neighbors, neighbors + count);
+      count = std::unique(neighbors, neighbors + count) - neighbors;
+      if ( out ) std::copy(neighbors, neighbors + count, out);
+      return count;
+    };
+    std::vector<Integer> offsets ( T + 1, 0 );
+    parallel_for(0, T, [&](Integer p){ offsets[p] = row(p, nullptr); });
+    Integer nnz = parallel_exclusive_scan(offsets);
+    std::vector<Integer> targets ( nnz );
+    parallel_for(0, T, [&](Integer p){ row(p, targets.data() + offsets[p]); });
+    graph_ = CompressedChains(std::move(offsets), std::move(targets));
+    Instrumentation::instance().add("flow graph edges", nnz);
+  }
+
+  /// complex
+  std::shared_ptr<CubicalComplex>
+  complex ( void ) const {
+    return complex_;
+  }
+
+  /// size
+  ///   Number of vertices (top cells)
+  Integer
+  size ( void ) const {
+    return graph_.size();
+  }
+
+  /// adjacencies
+  ///   Top cells the flow may reach from top cell v
+  std::vector<Integer>
+  adjacencies ( Integer v ) const {
+    Integer p = v - top_begin_;
+    if ( p < 0 || p >= size() ) throw std::out_of_range("FlowGraph: not a top cell");
+    std::vector<Integer> result;
+    graph_.for_each(p, [&](Integer u){ result.push_back(u); });
+    return result;
+  }
+
+  /// graph
+  ///   The graph in compressed sparse row form
+  CompressedChains const&
+  graph ( void ) const {
+    return graph_;
+  }
+
+private:
+  std::shared_ptr<CubicalComplex> complex_;
+  Integer top_begin_;
+  CompressedChains graph_;
+
+  /// neighbors_
+  ///   callback(wall, neighbor, right) for each wall of top cell c with a
+  ///   top cell on its other side; right if the neighbor has the greater
+  ///   coordinate
+  template < typename F >
+  void
+  neighbors_ ( Integer c, F const& callback ) const {
+    CubicalComplex const& X = *complex_;
+    Integer D = X.dimension();
+    Integer full = (1L << D) - 1;
+    if ( X.periodic() ) {
+      Integer L = X.type_size();
+      Integer p = c % L;
+      for ( Integer d = 0; d < D; ++ d ) {
+        Integer wall_type = L * X.TS()[full ^ (1L << d)];
+        Integer left = (p + L - X.PV()[d]) % L;
+        Integer right = (p + X.PV()[d]) % L;
+        if ( left != p ) callback(wall_type + p, c - p + left, false);
+        if ( right != p ) callback(wall_type + right, c - p + right, true);
+      }
+      return;
+    }
+    Integer x [ 64 ];
+    X.coordinates(c, x);
+    for ( Integer d = 0; d < D; ++ d ) {
+      Integer wall_shape = full ^ (1L << d);
+      if ( x[d] > 0 ) {
+        Integer wall = X.cell_index(x, wall_shape);
+        -- x[d];
+        callback(wall, X.cell_index(x, full), false);
+        ++ x[d];
+      }
+      if ( x[d] + 1 < X.boxes()[d] ) {
+        ++ x[d];
+        Integer wall = X.cell_index(x, wall_shape);
+        callback(wall, X.cell_index(x, full), true);
+        -- x[d];
+      }
+    }
+  }
+};
+
+/// VertexFieldFlowGraph
+///   Flow graph of a vector field sampled at the vertices of a cubical
+///   complex (field[v*D + d] being component d at vertex v): the flow
+///   crosses a wall with normal direction d one way only if component d
+///   has the same strict sign at all of the wall's vertices
+inline std::shared_ptr<FlowGraph>
+VertexFieldFlowGraph ( std::shared_ptr<CubicalComplex> complex, double const* field ) {
+  Integer D = complex -> dimension();
+  Integer full = (1L << D) - 1;
+  return std::make_shared<FlowGraph>(complex, [&](Integer wall){
+    Integer d = __builtin_ctzll(full ^ complex -> cell_shape(wall));
+    bool positive = true, negative = true;
+    cubical_vertices(*complex, wall, [&](Integer v){
+      double f = field[v*D + d];
+      positive = positive && f > 0;
+      negative = negative && f < 0;
+    });
+    return positive ? 1 : ( negative ? -1 : 0 );
+  });
+}
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+namespace py = pybind11;
+
+inline void
+FlowGraphBinding(py::module &m) {
+  py::class_<FlowGraph, std::shared_ptr<FlowGraph>>(m, "FlowGraph")
+    .def(py::init([](std::shared_ptr<CubicalComplex> complex,
+                     py::array_t<double, py::array::c_style | py::array::forcecast> samples) {
+      // samples : size(0) x D array of vector field values at the vertices,
+      //   or one value per wall (cell of dimension D-1), positive if the
+      //   flow crosses it towards increasing coordinate, negative if
+      //   towards decreasing, zero (or NaN) if either way
+      Integer D = complex -> dimension();
+      double const* data = samples.data();
+      py::gil_scoped_release release;
+      if ( samples.ndim() == 2 && samples.shape(0) == complex -> size(0) && samples.shape(1) == D ) {
+        return VertexFieldFlowGraph(complex, data);
+      }
+      if ( D > 0 && samples.ndim() == 1 && samples.shape(0) == complex -> size(D-1) ) {
+        Integer wall_begin = *(*complex)(D-1).begin();
+        return std::make_shared<FlowGraph>(complex, [&](Integer wall){
+          double f = data[wall - wall_begin];
+          return f > 0 ? 1 : ( f < 0 ? -1 : 0 );
+        });
+      }
+      throw std::invalid_argument("FlowGraph: need a (vertices x dimension) array or one value per wall");
+    }))
+    .def("complex", &FlowGraph::complex)
+    .def("size", &FlowGraph::size)
+    .def("__len__", &FlowGraph::size)
+    .def("__call__", &FlowGraph::adjacencies)
+    .def("adjacencies", &FlowGraph::adjacencies)
+    .def("csr", [](py::object self) {
+      // Returns (indptr, indices): the targets of row p (top cell p plus
+      // the first top cell) are indices[indptr[p]:indptr[p+1]]
+      auto const& graph = self.cast<FlowGraph const&>().graph();
+      return py::make_tuple(as_readonly_array(graph.offsets(), self),
+                            as_readonly_array(graph.entries(), self));
+    });
+}
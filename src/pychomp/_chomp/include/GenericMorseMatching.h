@@ -10,11 +10,19 @@
 #include <vector>
 
 #include "Integer.h"
+#include "IndexArray.h"
 #include "Chain.h"
 #include "Complex.h"
 #include "GradedComplex.h"
 #include "MorseMatching.h"
-
+#include "Progress.h"
+#include "Instrumentation.h"
+
+/// GenericMorseMatching
+///   Morse matching of an arbitrary (graded) complex by coreduction.
+///   Mates and priorities are IndexArrays: 32 bits per cell for complexes
+///   under 2^31 cells, unless the priorities (grade * size + order)
+///   overflow, in which case they are widened.
 class GenericMorseMatching : public MorseMatching {
 public:
   /// GenericMorseMatching
@@ -29,14 +37,25 @@ public:
     construct(graded_complex_ptr);
   }
 
+  /// GenericMorseMatching
+  ///   Restore a previously computed matching (see Serialization.h)
+  GenericMorseMatching ( std::vector<Integer> mate,
+                         std::vector<Integer> priority,
+                         BeginType begin,
+                         ReindexType reindex )
+                       : mate_(std::move(mate)), priority_(std::move(priority)),
+                         begin_(std::move(begin)), reindex_(std::move(reindex)) {}
+
   /// construct
   void
   construct ( std::shared_ptr<GradedComplex> graded_complex_ptr ) {
+    StageTimer timer ( "matching" );
     GradedComplex const& graded_complex = *graded_complex_ptr;
     Complex const& complex = *graded_complex.complex();
     Integer N = complex.size();
-    mate_.resize(N,-1);
-    priority_.resize(N);
+    Integer peak_coreducible = 0, peak_ace_candidates = 0;
+    mate_.assign(N, -1, N);
+    priority_.assign(N, 0, N);
     Integer num_processed = 0;
     std::vector<Integer> boundary_count (N);
     std::unordered_set<Integer> coreducible;
@@ -65,6 +84,7 @@ public:
     };
 
     for ( auto x : complex ) {
+      report_progress("matching (setup)", x, N);
       boundary_count[x] = bd(x).size();
       switch ( boundary_count[x] ) {
         case 0: ace_candidates.insert(x); break;
@@ -73,7 +93,7 @@ public:
     }
 
     auto process = [&](Integer y){
-      priority_[y] = graded_complex.value(y)*complex.size() + num_processed ++;
+      priority_.set(y, graded_complex.value(y)*complex.size() + num_processed ++);
       coreducible.erase(y);
       ace_candidates.erase(y);
       for ( auto x : cbd(y) ) {
@@ -86,6 +106,9 @@ public:
     };
 
     while ( num_processed < N ) {
+      report_progress("matching", num_processed, N);
+      peak_coreducible = std::max<Integer>(peak_coreducible, coreducible.size());
+      peak_ace_candidates = std::max<Integer>(peak_ace_candidates, ace_candidates.size());
       if ( not coreducible.empty() ) {
         Integer K, Q;
         // Extract K
@@ -95,13 +118,13 @@ public:
         if ( graded_complex.value(K) != graded_complex.value(Q) ) {
           throw std::logic_error("graded_complex error -- memory bug? MorseMatching line 132");
         }
-        mate_[K] = Q; mate_[Q] = K;
+        mate_.set(K, Q); mate_.set(Q, K);
         process(Q); process(K);
       } else {
         Integer A;
         // Error: what if there are zero ace candidates?
         auto it = ace_candidates.begin(); A = *it; ace_candidates.erase(it); // pop from unordered_set
-        mate_[A] = A;
+        mate_.set(A, A);
         process(A);
       }
     }
@@ -125,6 +148,11 @@ public:
     }
     begin_[D+1] = idx;
 
+    auto & instrumentation = Instrumentation::instance();
+    instrumentation.add("matching cells", N);
+    instrumentation.add("critical cells", idx);
+    instrumentation.peak("matching coreducible set", peak_coreducible);
+    instrumentation.peak("matching ace candidate set", peak_ace_candidates);
   }
 
   /// critical_cells
@@ -145,9 +173,23 @@ public:
     return priority_[x];
   }
 
+  /// mates
+  ///   mate(x) for every cell x
+  IndexArray const&
+  mates ( void ) const {
+    return mate_;
+  }
+
+  /// priorities
+  ///   priority(x) for every cell x
+  IndexArray const&
+  priorities ( void ) const {
+    return priority_;
+  }
+
 private:
-  std::vector<Integer> mate_;
-  std::vector<Integer> priority_;
+  IndexArray mate_;
+  IndexArray priority_;
   BeginType begin_;
   ReindexType reindex_;
 };
@@ -160,9 +202,21 @@ namespace py = pybind11;
 
 inline void
 GenericMorseMatchingBinding(py::module &m) {
-  py::class_<GenericMorseMatching, std::shared_ptr<GenericMorseMatching>>(m, "GenericMorseMatching")
-    .def(py::init<std::shared_ptr<Complex>>())
-    .def(py::init<std::shared_ptr<GradedComplex>>())    
+  py::class_<GenericMorseMatching, std::shared_ptr<GenericMorseMatching>, MorseMatching>(m, "GenericMorseMatching")
+    .def(py::init([](std::shared_ptr<Complex> complex, py::object progress,
+                     std::shared_ptr<CancellationToken> token, double interval) {
+       return with_progress(progress, token, interval, [&](){
+         return std::make_shared<GenericMorseMatching>(complex);
+       });
+     }), py::arg("complex"), py::arg("progress") = py::none(),
+         py::arg("token") = py::none(), py::arg("interval") = 0.1)
+    .def(py::init([](std::shared_ptr<GradedComplex> graded_complex, py::object progress,
+                     std::shared_ptr<CancellationToken> token, double interval) {
+       return with_progress(progress, token, interval, [&](){
+         return std::make_shared<GenericMorseMatching>(graded_complex);
+       });
+     }), py::arg("graded_complex"), py::arg("progress") = py::none(),
+         py::arg("token") = py::none(), py::arg("interval") = 0.1)
     .def("mate", &GenericMorseMatching::mate)
     .def("priority", &GenericMorseMatching::priority);
 }
@@ -15,6 +15,26 @@ public:
   GradedComplex ( std::shared_ptr<Complex> c, 
               std::function<Integer(Integer)> v ) : complex_(c), value_(v) {}
 
+  /// GradedComplex
+  ///   Dense grading: value(i) == values[i] for each cell i
+  GradedComplex ( std::shared_ptr<Complex> c,
+                  std::vector<Integer> values ) : complex_(c) {
+    if ( (Integer) values.size() != c -> size() ) {
+      throw std::invalid_argument("GradedComplex: need one value per cell");
+    }
+    auto owner = std::make_shared<std::vector<Integer>>(std::move(values));
+    assign_values_(owner -> data(), owner);
+  }
+
+  /// GradedComplex
+  ///   Dense grading stored in memory which is kept alive by "owner"
+  ///   (e.g. a memory-mapped file)
+  GradedComplex ( std::shared_ptr<Complex> c,
+                  Integer const* values,
+                  std::shared_ptr<void const> owner ) : complex_(c) {
+    assign_values_(values, owner);
+  }
+
   /// complex
   std::shared_ptr<Complex>
   complex ( void ) const {
@@ -33,6 +53,14 @@ public:
     return value_(i);
   }
 
+  /// values
+  ///   For dense gradings, the array of values (one per cell);
+  ///   otherwise nullptr
+  Integer const*
+  values ( void ) const {
+    return values_;
+  }
+
   /// count
   std::unordered_map<Integer,std::vector<Integer>>
   count ( void ) const {
@@ -51,6 +79,15 @@ public:
 private:
   std::shared_ptr<Complex> complex_;
   std::function<Integer(Integer)> value_;
+  Integer const* values_ = nullptr;
+  std::shared_ptr<void const> values_owner_;
+
+  void
+  assign_values_ ( Integer const* values, std::shared_ptr<void const> owner ) {
+    values_ = values;
+    values_owner_ = owner;
+    value_ = [values](Integer i){ return values[i]; };
+  }
 };
 
 /// Python Bindings
@@ -58,6 +95,7 @@ private:
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 
 namespace py = pybind11;
 
@@ -65,6 +103,17 @@ inline void
 GradedComplexBinding(py::module &m) {
   py::class_<GradedComplex, std::shared_ptr<GradedComplex>>(m, "GradedComplex")
     .def(py::init<std::shared_ptr<Complex>,std::function<Integer(Integer)>>())
+    .def(py::init([](std::shared_ptr<Complex> c, IntegerArray values) {
+       if ( values.ndim() != 1 ) throw std::invalid_argument("GradedComplex: values must be one-dimensional");
+       return std::make_shared<GradedComplex>(c, std::vector<Integer>(values.data(), values.data() + values.size()));
+     }))
+    .def("values", [](py::object self) -> py::object {
+       GradedComplex const& graded_complex = self.cast<GradedComplex const&>();
+       if ( graded_complex.values() == nullptr ) return py::none();
+       IntegerArray result ( graded_complex.complex() -> size(), graded_complex.values(), self );
+       result.attr("setflags")(py::arg("write") = false);
+       return result;
+     })
     .def("complex", &GradedComplex::complex)
     .def("value", &GradedComplex::value)
     .def("count", &GradedComplex::count);
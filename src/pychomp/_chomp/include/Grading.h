@@ -6,10 +6,13 @@
 #pragma once
 
 #include "common.h"
+#include "Instrumentation.h"
+#include "CubicalComplex.h"
 
 std::function<Integer(Integer)>
 construct_grading ( std::shared_ptr<Complex> c, 
                     std::function<Integer(Integer)> top_cell_grading ) {
+  StageTimer timer ( "grading" );
   // Copy top_cell_grading (with offset)
   std::vector<Integer> top_cell_grading_;
   top_cell_grading_.resize(c->size(c->dimension()));
@@ -17,6 +20,18 @@ construct_grading ( std::shared_ptr<Complex> c,
   for ( auto v : (*c)(c->dimension()) ) {
     top_cell_grading_[v - num_nontop_cells_] = top_cell_grading(v);
   }
+  // Cubical complexes visit their top stars without allocating
+  auto cubical = std::dynamic_pointer_cast<CubicalComplex>(c);
+  if ( cubical ) {
+    return [=](Integer x) {
+      Integer min_value = -1;
+      cubical -> topstar(x, [&](Integer v){
+        auto new_val = top_cell_grading_[v - num_nontop_cells_];
+        if ( min_value == -1 || new_val < min_value ) min_value = new_val;
+      });
+      return min_value;
+    };
+  }
   return [=](Integer x) { 
     // std::cout << "grading function\n";
     // std::cout << "top_cell_grading_.size() == " << top_cell_grading_.size() << "\n";
@@ -10,19 +10,84 @@
 #include "Integer.h"
 #include "Chain.h"
 #include "Complex.h"
+#include "DenseZ2.h"
+#include "SmithNormalForm.h"
 #include "MorseComplex.h"
 #include "MorseMatching.h"
+#include "Progress.h"
+#include "ResultCache.h"
+#include "Instrumentation.h"
 
 /// Homology
 inline
 std::shared_ptr<Complex> 
 Homology ( std::shared_ptr<Complex> base ) {
-  std::shared_ptr<Complex> next = base;
-  do {
+  return ResultCache::instance().fetch<Complex>(ResultCache::HOMOLOGY, base, nullptr, [&](){
+    StageTimer timer ( "homology" );
+    std::shared_ptr<Complex> next = base;
+    do {
+      base = next;
+      next.reset( new MorseComplex ( base ) );
+      Instrumentation::instance().append("critical cells per level", next -> size());
+    } while ( next -> size() != base -> size() );
+    return base;
+  });
+}
+
+/// BettiNumbers
+///   Betti numbers over Z/2Z, the sizes of Homology(base): b_d = n_d -
+///   rank d_d - rank d_{d+1} on a Morse reduction of base. The first
+///   reduction is always made (so that, as in Homology, the matching
+///   decides which cells count, e.g. leaving out the right fringe of a
+///   periodic cubical complex); further ones stop as soon as each
+///   boundary block fits the dense kernel (see DenseZ2.h). Small residual
+///   complexes thus take a few word-parallel eliminations rather than
+///   more Morse rounds. A block which still does not fit when the
+///   reductions make no more progress is ranked sparsely.
+inline
+std::vector<Integer>
+BettiNumbers ( std::shared_ptr<Complex> base ) {
+  StageTimer timer ( "betti numbers" );
+  auto fits = [](Complex const& complex){
+    for ( Integer d = 1; d <= complex.dimension(); ++ d ) {
+      if ( not dense_z2_fits(complex.size(d), complex.size(d-1)) ) return false;
+    }
+    return true;
+  };
+  std::shared_ptr<Complex> next ( new MorseComplex ( base ) );
+  Instrumentation::instance().append("critical cells per level", next -> size());
+  while ( next -> size() != base -> size() && not fits(*next) ) {
     base = next;
     next.reset( new MorseComplex ( base ) );
-  } while ( next -> size() != base -> size() );
-  return base;
+    Instrumentation::instance().append("critical cells per level", next -> size());
+  }
+  base = next;
+  Integer D = base -> dimension();
+  std::vector<Integer> rank ( D + 2, 0 );
+  for ( Integer d = 1; d <= D; ++ d ) {
+    Integer N = base -> size(d);
+    Integer row_begin = *(*base)(d).begin();
+    Integer column_begin = *(*base)(d-1).begin();
+    Integer entries = 0;
+    for ( Integer i = 0; i < N; ++ i ) base -> column(row_begin + i, [&](Integer){ ++ entries; });
+    if ( entries == 0 ) continue;
+    if ( not dense_z2_fits(N, base -> size(d-1)) ) {
+      std::vector<std::vector<std::pair<Integer,Integer>>> columns ( N );
+      for ( Integer i = 0; i < N; ++ i ) {
+        base -> column(row_begin + i, [&](Integer x){ columns[i].push_back({x - column_begin, 1}); });
+      }
+      rank[d] = SparseSmithNormalForm(base -> size(d-1), columns, Coefficients(2)).rank();
+      continue;
+    }
+    BitMatrix A ( N, base -> size(d-1) );
+    for ( Integer i = 0; i < N; ++ i ) {
+      base -> column(row_begin + i, [&](Integer x){ A.flip(i, x - column_begin); });
+    }
+    rank[d] = A.rank();
+  }
+  std::vector<Integer> result ( D + 1 );
+  for ( Integer d = 0; d <= D; ++ d ) result[d] = base -> size(d) - rank[d] - rank[d+1];
+  return result;
 }
 
 /// Python Bindings
@@ -33,5 +98,18 @@ namespace py = pybind11;
 
 inline
 void HomologyBinding(py::module &m) {
-  m.def("Homology", &Homology);
+  m.def("Homology", [](std::shared_ptr<Complex> base, py::object progress,
+                       std::shared_ptr<CancellationToken> token, double interval) {
+    return with_progress(progress, token, interval, [&](){
+      return Homology(base);
+    });
+  }, py::arg("base"), py::arg("progress") = py::none(),
+     py::arg("token") = py::none(), py::arg("interval") = 0.1);
+  m.def("BettiNumbers", [](std::shared_ptr<Complex> base, py::object progress,
+                           std::shared_ptr<CancellationToken> token, double interval) {
+    return with_progress(progress, token, interval, [&](){
+      return BettiNumbers(base);
+    });
+  }, py::arg("base"), py::arg("progress") = py::none(),
+     py::arg("token") = py::none(), py::arg("interval") = 0.1);
 }
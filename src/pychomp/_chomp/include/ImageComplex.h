@@ -0,0 +1,157 @@
+/// ImageComplex.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <stdexcept>
+
+#include "Integer.h"
+#include "Parallel.h"
+#include "CubicalComplex.h"
+#include "GradedComplex.h"
+#include "Instrumentation.h"
+
+/// image_levels_
+///   Replace levels by the distinct values of data[0], ..., data[T-1]
+///   in filtration order (increasing, or decreasing if upper), and write
+///   the position of each value among them into grades[0], ..., grades[T-1]
+template < typename T >
+void
+image_levels_ ( T const* data, Integer count, bool upper,
+                std::vector<T> & levels, Integer * grades ) {
+  levels.assign(data, data + count);
+  for ( auto const& x : levels ) {
+    if ( x != x ) throw std::invalid_argument("ImageGradedComplex: values must not be NaN");
+  }
+  auto before = [upper](T const& x, T const& y){ return upper ? y < x : x < y; };
+  parallel_sort(levels.begin(), levels.end(), before);
+  levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+  parallel_for(0, count, [&](Integer i){
+    grades[i] = std::lower_bound(levels.begin(), levels.end(), data[i], before) - levels.begin();
+  });
+}
+
+/// cubical_star_grades
+///   Grade every cell of a non-periodic cubical complex, given the grades
+///   of the top cells (or, if vertices, of the vertices) at their place
+///   in values: a cell gets the least grade over its top star (or the
+///   greatest grade over its vertices).
+///   The grades of the cells of each shape follow from those of a shape
+///   with one more (or one less) dimension of extent by a minimum (or
+///   maximum) of two neighbors along that dimension, so every shape takes
+///   one pass over contiguous rows.
+inline void
+cubical_star_grades ( CubicalComplex const& X, bool vertices, Integer * values ) {
+  if ( X.periodic() ) throw std::invalid_argument("cubical_star_grades: complex must not be periodic");
+  Integer D = X.dimension();
+  Integer M = 1L << D;
+  auto const& boxes = X.boxes();
+  // Shapes in order of decreasing (or increasing) dimension
+  for ( Integer k = 1; k < M; ++ k ) {
+    Integer s = vertices ? X.ST()[k] : X.ST()[M - 1 - k];
+    // the neighbor shape t differs from s in the lowest dimension d where
+    // s lacks (has) extent; along d, s has n cells and t has m of them
+    Integer d = 0;
+    while ( ((s >> d) & 1) == (vertices ? 0 : 1) ) ++ d;
+    Integer t = s ^ (1L << d);
+    Integer n = vertices ? boxes[d] : boxes[d] + 1;
+    Integer m = vertices ? boxes[d] + 1 : boxes[d];
+    Integer const* pv = X.shape_place_values(s);
+    Integer row = pv[d];
+    Integer rows = pv[D] / (row * n);
+    Integer * target = values + *X.shape_begin(s);
+    Integer const* source = values + *X.shape_begin(t);
+    parallel_for(0, rows, [&](Integer h){
+      for ( Integer x = 0; x < n; ++ x ) {
+        Integer * out = target + (h * n + x) * row;
+        if ( vertices ) {
+          // cell x lies between vertices x and x+1
+          Integer const* a = source + (h * m + x) * row;
+          Integer const* b = a + row;
+          for ( Integer i = 0; i < row; ++ i ) out[i] = std::max(a[i], b[i]);
+        } else {
+          // face x lies between the top cells x-1 and x (if present)
+          Integer const* a = source + (h * m + x) * row;
+          if ( x == 0 ) std::copy(a, a + row, out);
+          else if ( x == m ) std::copy(a - row, a, out);
+          else for ( Integer i = 0; i < row; ++ i ) out[i] = std::min(a[i - row], a[i]);
+        }
+      }
+    }, std::max<Integer>(1, 65536 / (row * n)));
+  }
+}
+
+/// ImageGradedComplex
+///   Non-periodic cubical complex of an image (in C order with the given
+///   shape, so the last axis is the first dimension of the complex),
+///   graded by filtration index: on return levels holds the distinct
+///   values of the image, increasing (or decreasing if upper), and a cell
+///   of grade g appears at level levels[g].
+///   If vertices is false the pixels are the top cells, and a cell gets
+///   the least grade over its top star; otherwise the pixels are the
+///   vertices, and a cell gets the greatest grade over its vertices
+///   (see cubical_star_grades).
+template < typename T >
+std::shared_ptr<GradedComplex>
+ImageGradedComplex ( std::vector<Integer> const& shape, T const* data,
+                     bool vertices, bool upper, std::vector<T> & levels ) {
+  StageTimer timer ( "grading" );
+  Integer D = shape.size();
+  if ( D == 0 ) throw std::invalid_argument("ImageGradedComplex: image has no dimensions");
+  std::vector<Integer> boxes ( shape.rbegin(), shape.rend() );
+  for ( auto & b : boxes ) {
+    if ( vertices ) b -= 1;
+    if ( b < 1 ) throw std::invalid_argument("ImageGradedComplex: image is too small");
+  }
+  auto complex = std::make_shared<CubicalComplex>(boxes, false);
+  std::vector<Integer> values ( complex -> size() );
+  Integer count = 1;
+  for ( auto n : shape ) count *= n;
+  // pixels, in C order, are the cells of the top (or vertex) shape in
+  // order of position (first coordinate fastest)
+  Integer first = vertices ? 0 : (1L << D) - 1;
+  image_levels_(data, count, upper, levels, values.data() + *complex -> shape_begin(first));
+  cubical_star_grades(*complex, vertices, values.data());
+  return std::make_shared<GradedComplex>(complex, std::move(values));
+}
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+namespace py = pybind11;
+
+/// ImageGradedComplexBinding_
+///   Overload of ImageGradedComplex for images of type T (used as is if
+///   C-contiguous, otherwise copied)
+template < typename T >
+inline void
+ImageGradedComplexBinding_(py::module &m, bool convert) {
+  m.def("ImageGradedComplex", [](py::array_t<T, py::array::c_style> image, bool vertices, bool upper) {
+    std::vector<Integer> shape ( image.shape(), image.shape() + image.ndim() );
+    T const* data = image.data();
+    std::vector<T> levels;
+    std::shared_ptr<GradedComplex> result;
+    {
+      py::gil_scoped_release release;
+      result = ImageGradedComplex(shape, data, vertices, upper, levels);
+    }
+    return py::make_tuple(result, levels);
+  }, py::arg("image").noconvert(not convert), py::arg("vertices") = false, py::arg("upper") = false);
+}
+
+inline void
+ImageComplexBinding(py::module &m) {
+  // ImageGradedComplex(image, vertices=False, upper=False) -> (graded complex, levels)
+  ImageGradedComplexBinding_<uint8_t>(m, false);
+  ImageGradedComplexBinding_<uint16_t>(m, false);
+  ImageGradedComplexBinding_<int32_t>(m, false);
+  ImageGradedComplexBinding_<int64_t>(m, false);
+  ImageGradedComplexBinding_<float>(m, false);
+  ImageGradedComplexBinding_<double>(m, true);
+}
@@ -0,0 +1,190 @@
+/// IndexArray.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include "Integer.h"
+
+/// IndexArray
+///   Array of cell indices, offsets or -1 sentinels. Values are stored
+///   as int32_t while they all fit (complexes under 2^31 cells), which
+///   halves the footprint of the big per-cell arrays; otherwise they are
+///   stored as Integer. Reads always give Integer.
+///   The width is chosen on construction. set() and push_back() of a
+///   value which does not fit widen the whole array, so they must not
+///   race with other accesses; writes of values known to fit (e.g. below
+///   the bound given on construction) may be made from several threads.
+///   Build with CHOMP_WIDE_INDICES defined to always store Integer.
+class IndexArray {
+public:
+  /// IndexArray
+  ///   Empty array
+  IndexArray ( void ) : wide_(not fits(0)) {}
+
+  /// IndexArray
+  ///   N copies of value, stored compactly if value and bound both fit
+  explicit
+  IndexArray ( Integer N, Integer value = 0, Integer bound = 0 ) {
+    assign ( N, value, bound );
+  }
+
+  /// IndexArray
+  ///   Take over the values of v, stored compactly if they all fit
+  explicit
+  IndexArray ( std::vector<Integer> && v ) {
+    wide_ = not std::all_of(v.begin(), v.end(), [](Integer x){ return fits(x); });
+    if ( wide_ ) {
+      wide_data_ = std::move(v);
+    } else {
+      narrow_data_.assign(v.begin(), v.end());
+      std::vector<Integer>().swap(v);
+    }
+  }
+
+  /// assign
+  ///   Replace contents with N copies of value
+  void
+  assign ( Integer N, Integer value = 0, Integer bound = 0 ) {
+    wide_ = not (fits(value) && fits(bound));
+    narrow_data_.clear();
+    wide_data_.clear();
+    if ( wide_ ) wide_data_.assign(N, value); else narrow_data_.assign(N, value);
+  }
+
+  /// fits
+  ///   True if v can be stored compactly
+  static bool
+  fits ( Integer v ) {
+#ifdef CHOMP_WIDE_INDICES
+    (void) v;
+    return false;
+#else
+    return v >= std::numeric_limits<int32_t>::min() && v <= std::numeric_limits<int32_t>::max();
+#endif
+  }
+
+  /// size
+  Integer
+  size ( void ) const {
+    return wide_ ? wide_data_.size() : narrow_data_.size();
+  }
+
+  /// empty
+  bool
+  empty ( void ) const {
+    return size() == 0;
+  }
+
+  /// wide
+  ///   True if values are stored as Integer
+  bool
+  wide ( void ) const {
+    return wide_;
+  }
+
+  /// operator []
+  Integer
+  operator [] ( Integer i ) const {
+    return wide_ ? wide_data_[i] : narrow_data_[i];
+  }
+
+  /// set
+  void
+  set ( Integer i, Integer v ) {
+    if ( not wide_ && not fits(v) ) widen ();
+    if ( wide_ ) wide_data_[i] = v; else narrow_data_[i] = v;
+  }
+
+  /// push_back
+  void
+  push_back ( Integer v ) {
+    if ( not wide_ && not fits(v) ) widen ();
+    if ( wide_ ) wide_data_.push_back(v); else narrow_data_.push_back(v);
+  }
+
+  /// widen
+  ///   Switch to Integer storage
+  void
+  widen ( void ) {
+    if ( wide_ ) return;
+    wide_data_.assign(narrow_data_.begin(), narrow_data_.end());
+    std::vector<int32_t>().swap(narrow_data_);
+    wide_ = true;
+  }
+
+  /// for_range
+  ///   Call f on values i = begin, ..., end-1 in order
+  template < typename F >
+  void
+  for_range ( Integer begin, Integer end, F const& f ) const {
+    if ( wide_ ) {
+      for ( auto p = wide_data_.data() + begin; p != wide_data_.data() + end; ++ p ) f(*p);
+    } else {
+      for ( auto p = narrow_data_.data() + begin; p != narrow_data_.data() + end; ++ p ) f(*p);
+    }
+  }
+
+  /// sort
+  ///   Sort the values at positions begin, ..., end-1
+  void
+  sort ( Integer begin, Integer end ) {
+    if ( wide_ ) {
+      std::sort(wide_data_.begin() + begin, wide_data_.begin() + end);
+    } else {
+      std::sort(narrow_data_.begin() + begin, narrow_data_.begin() + end);
+    }
+  }
+
+  /// lower_bound
+  ///   First position whose value is not less than v (values must be sorted)
+  Integer
+  lower_bound ( Integer v ) const {
+    if ( wide_ ) return std::lower_bound(wide_data_.begin(), wide_data_.end(), v) - wide_data_.begin();
+    return std::lower_bound(narrow_data_.begin(), narrow_data_.end(), v) - narrow_data_.begin();
+  }
+
+  /// is_sorted
+  bool
+  is_sorted ( void ) const {
+    if ( wide_ ) return std::is_sorted(wide_data_.begin(), wide_data_.end());
+    return std::is_sorted(narrow_data_.begin(), narrow_data_.end());
+  }
+
+  /// wide_data
+  ///   Storage when wide()
+  std::vector<Integer> const&
+  wide_data ( void ) const {
+    return wide_data_;
+  }
+
+  /// narrow_data
+  ///   Storage when not wide()
+  std::vector<int32_t> const&
+  narrow_data ( void ) const {
+    return narrow_data_;
+  }
+
+  /// to_vector
+  ///   Copy of the values as Integer
+  std::vector<Integer>
+  to_vector ( void ) const {
+    if ( wide_ ) return wide_data_;
+    return std::vector<Integer>(narrow_data_.begin(), narrow_data_.end());
+  }
+
+  /// memory
+  ///   Bytes used by the values
+  Integer
+  memory ( void ) const {
+    return wide_ ? sizeof(Integer) * wide_data_.size() : sizeof(int32_t) * narrow_data_.size();
+  }
+
+private:
+  bool wide_;
+  std::vector<int32_t> narrow_data_;
+  std::vector<Integer> wide_data_;
+};
@@ -0,0 +1,298 @@
+/// Instrumentation.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "Integer.h"
+
+/// Instrumentation
+///   Process-wide record of stage timings, counters, peak sizes and
+///   per-level series. Disabled by default; when disabled every hook is a
+///   single relaxed atomic load. Counters and peaks are atomics, found
+///   through a per-thread cache, so updating them takes no lock; stages
+///   and series take one. Hot loops should still count locally and hand
+///   totals over once per call (see MorseComplex::flow).
+class Instrumentation {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  /// TraceEvent
+  ///   A completed stage, for trace export
+  struct TraceEvent {
+    std::string name;
+    Integer start_us;
+    Integer duration_us;
+    uint64_t thread;
+  };
+
+  /// StageTotal
+  struct StageTotal {
+    Integer calls = 0;
+    double seconds = 0.0;
+  };
+
+  /// instance
+  static Instrumentation &
+  instance ( void ) {
+    static Instrumentation instrumentation;
+    return instrumentation;
+  }
+
+  /// enabled
+  bool
+  enabled ( void ) const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /// enable
+  void
+  enable ( bool on ) {
+    enabled_ = on;
+  }
+
+  /// reset
+  ///   Discard everything recorded so far
+  void
+  reset ( void ) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stages_.clear();
+    // slots stay allocated, as threads keep pointers to them
+    for ( auto & kv : counters_ ) kv.second -> clear();
+    for ( auto & kv : peaks_ ) kv.second -> clear();
+    series_.clear();
+    events_.clear();
+    origin_ = Clock::now();
+  }
+
+  /// add
+  ///   Add amount to a counter. Counter and peak names are string
+  ///   literals, as threads cache slots by the name's address.
+  void
+  add ( char const* counter, Integer amount ) {
+    if ( not enabled() ) return;
+    static thread_local std::unordered_map<char const*, Slot*> cache;
+    Slot & slot = slot_(cache, counters_, counter);
+    slot.value.fetch_add(amount, std::memory_order_relaxed);
+    slot.touch();
+  }
+
+  /// peak
+  ///   Record value as a candidate maximum for a peak size
+  void
+  peak ( char const* name, Integer value ) {
+    if ( not enabled() ) return;
+    static thread_local std::unordered_map<char const*, Slot*> cache;
+    Slot & slot = slot_(cache, peaks_, name);
+    Integer current = slot.value.load(std::memory_order_relaxed);
+    while ( current < value &&
+            not slot.value.compare_exchange_weak(current, value, std::memory_order_relaxed) ) {}
+    slot.touch();
+  }
+
+  /// append
+  ///   Append value to a series (e.g. one entry per tower level)
+  void
+  append ( char const* name, Integer value ) {
+    if ( not enabled() ) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    series_[name].push_back(value);
+  }
+
+  /// stage
+  ///   Record a completed stage
+  void
+  stage ( char const* name, Clock::time_point start, Clock::time_point stop ) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    StageTotal & total = stages_[name];
+    total.calls += 1;
+    total.seconds += std::chrono::duration<double>(stop - start).count();
+    if ( events_.size() < max_events_ ) {
+      TraceEvent event;
+      event.name = name;
+      event.start_us = std::chrono::duration_cast<std::chrono::microseconds>(start - origin_).count();
+      event.duration_us = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+      event.thread = std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFFFF;
+      events_.push_back(event);
+    }
+  }
+
+  /// stages / counters / peaks / series / events
+  ///   Snapshots of what has been recorded
+  std::map<std::string, StageTotal>
+  stages ( void ) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stages_;
+  }
+
+  std::map<std::string, Integer>
+  counters ( void ) const {
+    return snapshot_(counters_);
+  }
+
+  std::map<std::string, Integer>
+  peaks ( void ) const {
+    return snapshot_(peaks_);
+  }
+
+  std::map<std::string, std::vector<Integer>>
+  series ( void ) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return series_;
+  }
+
+  std::vector<TraceEvent>
+  events ( void ) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+  }
+
+  /// chrome_trace
+  ///   Write recorded stages in Chrome trace-event JSON format
+  ///   (viewable in chrome://tracing or Perfetto)
+  void
+  chrome_trace ( std::ostream & out ) const {
+    auto recorded = events();
+    out << "{\"traceEvents\":[";
+    for ( uint64_t i = 0; i < recorded.size(); ++ i ) {
+      auto const& event = recorded[i];
+      if ( i > 0 ) out << ",";
+      out << "\n{\"name\":\"" << event.name << "\",\"cat\":\"pychomp\",\"ph\":\"X\""
+          << ",\"ts\":" << event.start_us << ",\"dur\":" << event.duration_us
+          << ",\"pid\":1,\"tid\":" << event.thread << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  }
+
+private:
+  /// Slot
+  ///   Value of a counter or peak. "used" is set by the first update
+  ///   since the last reset, so untouched slots are not reported.
+  struct Slot {
+    std::atomic<Integer> value;
+    std::atomic<bool> used;
+
+    Slot ( void ) : value(0), used(false) {}
+
+    void
+    touch ( void ) {
+      if ( not used.load(std::memory_order_relaxed) ) used.store(true, std::memory_order_relaxed);
+    }
+
+    void
+    clear ( void ) {
+      value = 0;
+      used = false;
+    }
+  };
+
+  typedef std::map<std::string, std::unique_ptr<Slot>> Slots;
+
+  Instrumentation ( void ) : enabled_(false), origin_(Clock::now()) {}
+
+  /// slot_
+  ///   The slot for name, from the calling thread's cache if possible.
+  ///   Slots are never freed, so cached pointers stay valid.
+  Slot &
+  slot_ ( std::unordered_map<char const*, Slot*> & cache, Slots & slots, char const* name ) {
+    auto it = cache.find(name);
+    if ( it != cache.end() ) return *it -> second;
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Slot> & slot = slots[name];
+    if ( not slot ) slot.reset(new Slot);
+    cache[name] = slot.get();
+    return *slot;
+  }
+
+  /// snapshot_
+  std::map<std::string, Integer>
+  snapshot_ ( Slots const& slots ) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, Integer> result;
+    for ( auto const& kv : slots ) {
+      if ( kv.second -> used ) result[kv.first] = kv.second -> value;
+    }
+    return result;
+  }
+
+  std::atomic<bool> enabled_;
+  mutable std::mutex mutex_;
+  Clock::time_point origin_;
+  std::map<std::string, StageTotal> stages_;
+  Slots counters_;
+  Slots peaks_;
+  std::map<std::string, std::vector<Integer>> series_;
+  std::vector<TraceEvent> events_;
+  static const uint64_t max_events_ = 1000000;
+};
+
+/// StageTimer
+///   Times the enclosing scope as the named stage (if instrumentation is enabled)
+class StageTimer {
+public:
+  StageTimer ( char const* name ) : name_(name), active_(Instrumentation::instance().enabled()) {
+    if ( active_ ) start_ = Instrumentation::Clock::now();
+  }
+
+  ~StageTimer ( void ) {
+    if ( active_ ) Instrumentation::instance().stage(name_, start_, Instrumentation::Clock::now());
+  }
+
+private:
+  char const* name_;
+  bool active_;
+  Instrumentation::Clock::time_point start_;
+};
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+namespace py = pybind11;
+
+inline void
+InstrumentationBinding(py::module &m) {
+  m.def("instrumentation_enable", [](bool on) {
+    Instrumentation::instance().enable(on);
+  }, py::arg("on") = true);
+  m.def("instrumentation_enabled", []() {
+    return Instrumentation::instance().enabled();
+  });
+  m.def("instrumentation_reset", []() {
+    Instrumentation::instance().reset();
+  });
+  m.def("instrumentation_report", []() {
+    // {"stages": {name: {"calls": n, "seconds": t}}, "counters": {...},
+    //  "peaks": {...}, "series": {...}}
+    auto & instrumentation = Instrumentation::instance();
+    py::dict stages;
+    for ( auto const& kv : instrumentation.stages() ) {
+      py::dict stage;
+      stage["calls"] = kv.second.calls;
+      stage["seconds"] = kv.second.seconds;
+      stages[py::str(kv.first)] = stage;
+    }
+    py::dict result;
+    result["stages"] = stages;
+    result["counters"] = instrumentation.counters();
+    result["peaks"] = instrumentation.peaks();
+    result["series"] = instrumentation.series();
+    return result;
+  });
+  m.def("instrumentation_chrome_trace", [](std::string const& path) {
+    std::ofstream outfile ( path );
+    Instrumentation::instance().chrome_trace(outfile);
+    if ( not outfile ) throw std::runtime_error("cannot write " + path);
+  });
+}
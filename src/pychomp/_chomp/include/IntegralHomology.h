@@ -0,0 +1,237 @@
+/// IntegralHomology.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <stdexcept>
+
+#include "Integer.h"
+#include "Complex.h"
+#include "CompressedChains.h"
+#include "MorseComplex.h"
+#include "MorseMatching.h"
+#include "SmithNormalForm.h"
+#include "Parallel.h"
+#include "Progress.h"
+#include "Instrumentation.h"
+
+/// SignedChains
+///   Integer boundary matrix in compressed sparse column form: column i
+///   has the faces entries[k] with coefficients coefficients[k], for
+///   k = offsets[i], ..., offsets[i+1]-1, in increasing order of face
+struct SignedChains {
+  std::vector<Integer> offsets;
+  std::vector<Integer> entries;
+  std::vector<Integer> coefficients;
+
+  /// for_each
+  ///   Call f(face, coefficient) on each entry of column i
+  template < typename F >
+  void
+  for_each ( Integer i, F const& f ) const {
+    for ( Integer k = offsets[i]; k < offsets[i+1]; ++ k ) f(entries[k], coefficients[k]);
+  }
+
+  /// coefficient
+  ///   Coefficient of face x in column i
+  Integer
+  coefficient ( Integer i, Integer x ) const {
+    auto b = entries.begin() + offsets[i], e = entries.begin() + offsets[i+1];
+    auto it = std::lower_bound(b, e, x);
+    return ( it != e && *it == x ) ? coefficients[it - entries.begin()] : 0;
+  }
+
+  /// assign
+  ///   Fill from the columns given as (face, coefficient) lists, adding
+  ///   repeated faces and dropping zero coefficients
+  void
+  assign ( std::vector<std::vector<std::pair<Integer,Integer>>> & columns ) {
+    Integer N = columns.size();
+    parallel_for(0, N, [&](Integer i){
+      auto & column = columns[i];
+      std::sort(column.begin(), column.end());
+      Integer n = 0;
+      for ( Integer k = 0; k < (Integer) column.size(); ) {
+        Integer x = column[k].first, c = 0;
+        for ( ; k < (Integer) column.size() && column[k].first == x; ++ k ) c += column[k].second;
+        if ( c != 0 ) column[n++] = {x, c};
+      }
+      column.resize(n);
+    });
+    offsets.assign(N + 1, 0);
+    for ( Integer i = 0; i < N; ++ i ) offsets[i+1] = offsets[i] + columns[i].size();
+    entries.resize(offsets[N]);
+    coefficients.resize(offsets[N]);
+    parallel_for(0, N, [&](Integer i){
+      Integer k = offsets[i];
+      for ( auto const& entry : columns[i] ) {
+        entries[k] = entry.first;
+        coefficients[k++] = entry.second;
+      }
+    });
+  }
+
+  /// mod2
+  ///   The boundary matrix over Z/2Z
+  CompressedChains
+  mod2 ( void ) const {
+    Integer N = offsets.size() - 1;
+    std::vector<Integer> reduced_offsets ( N + 1, 0 ), reduced_entries;
+    for ( Integer i = 0; i < N; ++ i ) {
+      for_each(i, [&](Integer x, Integer c){ if ( c % 2 != 0 ) reduced_entries.push_back(x); });
+      reduced_offsets[i+1] = reduced_entries.size();
+    }
+    return CompressedChains(std::move(reduced_offsets), std::move(reduced_entries));
+  }
+};
+
+/// signed_boundary_
+///   The integer boundary matrix of a complex, from signed_column
+inline SignedChains
+signed_boundary_ ( Complex const& complex ) {
+  std::vector<std::vector<std::pair<Integer,Integer>>> columns ( complex.size() );
+  parallel_for(0, complex.size(), [&](Integer i){
+    complex.signed_column(i, [&](Integer x, Integer c){ columns[i].push_back({x, c}); });
+  });
+  SignedChains result;
+  result.assign(columns);
+  return result;
+}
+
+/// signed_morse_boundary_
+///   The integer boundary matrix of the Morse complex of a complex with
+///   integer boundary bd, by the matching: the boundary of each critical
+///   cell is flowed as in MorseComplex::flow, a queen q with coefficient
+///   c being cleared by adding -c/e times the boundary of its king, where
+///   e = +-1 is the coefficient of q in it. Critical cells are flowed in
+///   parallel. Returns false (leaving result alone) if some queen has a
+///   coefficient other than +-1 in the boundary of its king.
+inline bool
+signed_morse_boundary_ ( Complex const& complex, SignedChains const& bd,
+                         MorseMatching const& matching, SignedChains & result ) {
+  Integer N = complex.size();
+  std::vector<char> invertible ( N, 1 );
+  parallel_for(0, N, [&](Integer x){
+    Integer king = matching.mate(x);
+    if ( x < king ) {
+      Integer e = bd.coefficient(king, x);
+      invertible[x] = ( e == 1 || e == -1 );
+    }
+  });
+  if ( std::find(invertible.begin(), invertible.end(), 0) != invertible.end() ) return false;
+  auto const& reindex = matching.critical_cells().second;
+  Integer M = reindex.size();
+  std::vector<Integer> include ( M ), project ( N, -1 );
+  for ( auto const& pair : reindex ) {
+    include[pair.second] = pair.first;
+    project[pair.first] = pair.second;
+  }
+  std::vector<std::vector<std::pair<Integer,Integer>>> columns ( M );
+  Coefficients Z;
+  parallel_for(0, M, [&](Integer i){
+    std::unordered_map<Integer,Integer> canonical;
+    auto compare = [&](Integer x, Integer y){ return matching.priority(x) < matching.priority(y); };
+    std::priority_queue<Integer, std::vector<Integer>, decltype(compare)> queens ( compare );
+    auto process = [&](Integer x, Integer c){
+      Integer & value = canonical[x];
+      value = Z.add(value, c);
+      if ( value == 0 ) canonical.erase(x);
+      else if ( x < matching.mate(x) ) queens.push(x);
+    };
+    bd.for_each(include[i], process);
+    while ( not queens.empty() ) {
+      Integer queen = queens.top(); queens.pop();
+      auto it = canonical.find(queen);
+      if ( it == canonical.end() ) continue;
+      Integer king = matching.mate(queen);
+      Integer factor = Z.neg(Z.mul(it -> second, bd.coefficient(king, queen)));
+      bd.for_each(king, [&](Integer x, Integer c){ process(x, Z.mul(factor, c)); });
+    }
+    for ( auto const& entry : canonical ) {
+      if ( project[entry.first] != -1 ) columns[i].push_back({project[entry.first], entry.second});
+    }
+  });
+  result.assign(columns);
+  return true;
+}
+
+/// HomologyGroup
+///   rank and torsion (invariant factors greater than 1, each dividing
+///   the next) of a finitely generated abelian group, or of a vector
+///   space over Z/pZ (no torsion)
+struct HomologyGroup {
+  Integer rank;
+  std::vector<Integer> torsion;
+};
+
+/// HomologyGroups
+///   Homology of a complex with integer coefficients (modulus 0) or
+///   coefficients in Z/pZ (modulus p, a prime), for complexes with an
+///   integer boundary (see Complex::signed_column). The complex is
+///   Morse reduced as in Homology, with the same matchings, carrying
+///   the integer boundary along by signed flow (and the Z/2Z boundary
+///   for the next matching, which is its reduction); this stops when a
+///   matching pairs cells whose incidence is not +-1. The boundary
+///   blocks left are then diagonalized by SparseSmithNormalForm.
+///   The Z/2Z path (Homology) is unchanged.
+inline std::vector<HomologyGroup>
+HomologyGroups ( std::shared_ptr<Complex> base, Integer modulus = 0 ) {
+  Coefficients R ( modulus );
+  StageTimer timer ( "homology groups" );
+  SignedChains bd = signed_boundary_(*base);
+  while ( true ) {
+    auto matching = MorseMatching::compute_matching(base);
+    if ( (Integer) matching -> critical_cells().second.size() == base -> size() ) break;
+    SignedChains next_bd;
+    if ( not signed_morse_boundary_(*base, bd, *matching, next_bd) ) break;
+    base = std::make_shared<MorseComplex>(base, matching, next_bd.mod2());
+    bd = std::move(next_bd);
+    Instrumentation::instance().append("critical cells per level", base -> size());
+  }
+  Integer D = base -> dimension();
+  std::vector<Integer> rank ( D + 2, 0 );
+  std::vector<std::vector<Integer>> torsion ( D + 2 );
+  for ( Integer d = 1; d <= D; ++ d ) {
+    Integer first = *(*base)(d).begin();
+    Integer face_first = *(*base)(d-1).begin();
+    std::vector<std::vector<std::pair<Integer,Integer>>> columns ( base -> size(d) );
+    for ( Integer j = 0; j < base -> size(d); ++ j ) {
+      bd.for_each(first + j, [&](Integer x, Integer c){ columns[j].push_back({x - face_first, c}); });
+    }
+    SparseSmithNormalForm snf ( base -> size(d-1), columns, R );
+    rank[d] = snf.rank();
+    torsion[d] = snf.torsion();
+  }
+  std::vector<HomologyGroup> result ( D + 1 );
+  for ( Integer d = 0; d <= D; ++ d ) {
+    result[d].rank = base -> size(d) - rank[d] - rank[d+1];
+    result[d].torsion = torsion[d+1];
+  }
+  return result;
+}
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+namespace py = pybind11;
+
+inline void
+IntegralHomologyBinding(py::module &m) {
+  m.def("HomologyGroups", [](std::shared_ptr<Complex> base, Integer modulus, py::object progress,
+                             std::shared_ptr<CancellationToken> token, double interval) {
+    // Returns [(rank, torsion)] for each dimension: H_d is Z^rank plus
+    // Z/t for each t in torsion (with modulus p, (Z/p)^rank)
+    auto groups = with_progress(progress, token, interval, [&](){
+      return HomologyGroups(base, modulus);
+    });
+    py::list result;
+    for ( auto const& group : groups ) result.append(py::make_tuple(group.rank, group.torsion));
+    return result;
+  }, py::arg("base"), py::arg("modulus") = 0, py::arg("progress") = py::none(),
+     py::arg("token") = py::none(), py::arg("interval") = 0.1);
+}
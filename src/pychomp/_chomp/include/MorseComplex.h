@@ -12,10 +12,15 @@
 #include <vector>
 
 #include "Integer.h"
+#include "IndexArray.h"
 #include "Iterator.h"
 #include "Chain.h"
+#include "CompressedChains.h"
 #include "Complex.h"
+#include "DenseZ2.h"
 #include "MorseMatching.h"
+#include "Progress.h"
+#include "Instrumentation.h"
 
 class MorseComplex : public Complex {
 public:
@@ -32,31 +37,51 @@ public:
       begin_.push_back(Iterator(i));
     }
     dim_ = begin_.size()-2;
-    auto const& reindex = begin_reindex.second;
-
-    for ( auto pair : reindex ) {
-      include_.push_back(pair.first);
-    }
-    project_ = std::unordered_map<Integer, Integer>(reindex.begin(), reindex.end());
+    reindex_(begin_reindex.second);
 
     // boundary
-    bd_.resize(size());
+    StageTimer timer ( "boundary" );
+    std::vector<Chain> bd (size());
     //std::cout << "MorseComplex. There are " << size() << " cells.\n";
     //std::cout << "MorseComplex. Computing boundary.\n";
-    for ( auto ace : *this ) {
-      //std::cout << "  Computing boundary for cell ace ==" << ace << "\n";
-      //std::cout << "     include({ace}) = " << include({ace}) << "\n";
-      bd_[ace] = lower(base()->boundary(include({ace})));
-      //std::cout << "     bd(ace) = " << bd_[ace] << "\n";
+    for ( Integer d = 0; d < dim_; ++ d ) {
+      if ( dense_boundary_(d, bd) ) continue;
+      for ( auto ace : (*this)(d+1) ) {
+        report_progress("boundary", ace, size());
+        //std::cout << "  Computing boundary for cell ace ==" << ace << "\n";
+        //std::cout << "     include({ace}) = " << include({ace}) << "\n";
+        bd[ace] = lower(base()->boundary(include({ace})));
+        //std::cout << "     bd(ace) = " << bd[ace] << "\n";
+      }
     }
+    bd_ = CompressedChains(bd);
 
     //std::cout << "MorseComplex. Computing coboundary.\n";
     // coboundary
-    cbd_.resize(size());
-    for ( auto ace : *this ) {
-      for ( auto bd_cell : bd_[ace] ) cbd_[bd_cell] += ace;
-    }
+    cbd_ = bd_.transpose(size());
+    Instrumentation::instance().add("boundary cells", size());
+    Instrumentation::instance().add("boundary entries", bd_.nnz());
+  }
 
+  /// MorseComplex
+  ///   Restore a Morse complex whose boundary was previously computed
+  ///   (see Serialization.h)
+  MorseComplex ( std::shared_ptr<Complex> arg_base,
+                 std::shared_ptr<MorseMatching> arg_matching,
+                 CompressedChains bd )
+               : base_(arg_base), matching_(arg_matching) {
+    auto begin_reindex = matching_ -> critical_cells();
+    begin_.clear();
+    for ( auto i : begin_reindex.first ) {
+      begin_.push_back(Iterator(i));
+    }
+    dim_ = begin_.size()-2;
+    reindex_(begin_reindex.second);
+    if ( bd.size() != size() ) {
+      throw std::invalid_argument("MorseComplex: boundary does not match critical cells");
+    }
+    bd_ = std::move(bd);
+    cbd_ = bd_.transpose(size());
   }
 
   /// delegating constructor
@@ -69,7 +94,7 @@ public:
   virtual Chain
   boundary ( Chain const& c ) const final {
     Chain result;
-    for ( auto x : c ) result += bd_[x];
+    for ( auto x : c ) bd_.for_each(x, [&](Integer y){ result += y; });
     return result;
   }
 
@@ -77,7 +102,7 @@ public:
   virtual Chain
   coboundary ( Chain const& c ) const final {
     Chain result;
-    for ( auto x : c ) result += cbd_[x];
+    for ( auto x : c ) cbd_.for_each(x, [&](Integer y){ result += y; });
     return result;
   }
 
@@ -86,7 +111,7 @@ public:
   ///   boundary matrix
   virtual void
   column ( Integer i, std::function<void(Integer)> const& callback) const final {
-    for ( auto x : bd_[i] ) callback(x);
+    bd_.for_each(i, callback);
   };
 
   /// row
@@ -94,8 +119,14 @@ public:
   ///   boundary matrix
   virtual void
   row ( Integer i, std::function<void(Integer)> const& callback) const final {
-    for ( auto x : cbd_[i] ) callback(x);
+    cbd_.for_each(i, callback);
   };
+
+  /// compressed_boundary
+  virtual CompressedChains const*
+  compressed_boundary ( void ) const final {
+    return &bd_;
+  }
   
 
   // Feature
@@ -112,6 +143,15 @@ public:
     return matching_;
   }
 
+  /// memory
+  ///   Bytes used by the boundaries and the include/project tables
+  ///   (not counting the base complex or the matching)
+  Integer
+  memory ( void ) const {
+    return include_.memory() + bd_.memory() + cbd_.memory() +
+           project_.size() * (sizeof(std::pair<Integer const,Integer>) + 2 * sizeof(void*));
+  }
+
   /// include
   Chain
   include ( Chain const& c ) {
@@ -125,7 +165,8 @@ public:
   project ( Chain const& c ) {
     Chain result;
     for ( auto x : c ) { 
-      if ( project_.count(x) > 0 ) result += project_[x];
+      Integer y = project_cell_(x);
+      if ( y != -1 ) result += y;
     }
     return result;
   }
@@ -157,10 +198,12 @@ public:
     std::priority_queue<Integer, std::vector<Integer>, decltype(compare)> priority ( compare );
     auto isQueen = [&](Integer x){ return x < matching_ -> mate(x); };
 
+    Integer pushes = 0, pops = 0, peak_queue = 0, peak_chain = 0;
     auto process = [&](Integer x) {
       if ( isQueen(x) ) { //&& queens.count(x) == 0) {
         //queens . insert (x);
         priority . push (x);
+        ++ pushes;
       }
       canonical += x;
     };
@@ -169,7 +212,11 @@ public:
 
     while ( not priority . empty () ) {
       // std::cout << "  Current chain = " << canonical << "\n";
+      check_progress();
+      peak_queue = std::max<Integer>(peak_queue, priority.size());
+      peak_chain = std::max<Integer>(peak_chain, canonical.size());
       auto queen = priority.top(); priority.pop();
+      ++ pops;
       if ( canonical . count ( queen ) == 0 ) continue;
       auto king = matching_ -> mate ( queen );
       gamma += king;
@@ -179,17 +226,138 @@ public:
       //process( base()->boundary({king}) );
     }
     // std::cout << "  COMPLETE chain = " << canonical << "\n";
+    auto & instrumentation = Instrumentation::instance();
+    if ( instrumentation.enabled() ) {
+      instrumentation.add("flow calls", 1);
+      instrumentation.add("flow queue pushes", pushes);
+      instrumentation.add("flow queue pops", pops);
+      instrumentation.peak("flow queue size", peak_queue);
+      instrumentation.peak("flow chain size", peak_chain);
+    }
 
     return {canonical, gamma};
   }
 
 private:
+  /// dense_boundary_
+  ///   Compute the boundaries of all critical cells of dimension d+1 at
+  ///   once, if the base is itself a Morse complex (a residual block, not
+  ///   the first reduction of a large complex) and the cells of dimension
+  ///   d of the base times these critical cells fit in dense_z2_limit()
+  ///   bits; otherwise return false.
+  ///   Row x of a bit matrix holds the critical cells whose flowed
+  ///   boundary contains base cell x. The queens of dimension d are
+  ///   cleared in an order compatible with flow by adding their row to
+  ///   the rows of their king's boundary, so each step is a run of word
+  ///   XORs shared by all the flows, split over the threads by columns.
+  ///   Same result as lower.
+  bool
+  dense_boundary_ ( Integer d, std::vector<Chain> & bd ) {
+    Complex const& B = *base();
+    Integer N = B.size(d);
+    Integer C = size(d+1);
+    if ( C == 0 ) return true;
+    if ( not dynamic_cast<MorseComplex const*>(&B) ) return false;
+    if ( not dense_z2_fits(N, C) ) return false;
+    Integer row_begin = *B(d).begin();
+    Integer first = *(*this)(d+1).begin();
+    BitMatrix rows ( N, C );
+    for ( Integer j = 0; j < C; ++ j ) {
+      B.column(include_[first + j], [&](Integer x){ rows.flip(x - row_begin, j); });
+    }
+    // queens of dimension d, their kings' boundaries, and the number of
+    // other queens in whose king's boundary each queen lies
+    std::vector<Integer> queen ( N, -1 ), queens, offsets ( 1, 0 ), faces;
+    for ( Integer x = row_begin; x < row_begin + N; ++ x ) {
+      if ( x < matching_ -> mate(x) ) {
+        queen[x - row_begin] = queens.size();
+        queens.push_back(x - row_begin);
+      }
+    }
+    Integer Q = queens.size();
+    std::vector<Integer> incoming ( Q, 0 );
+    for ( Integer q = 0; q < Q; ++ q ) {
+      B.column(matching_ -> mate(row_begin + queens[q]), [&](Integer x){
+        x -= row_begin;
+        faces.push_back(x);
+        if ( x != queens[q] && queen[x] != -1 ) ++ incoming[queen[x]];
+      });
+      offsets.push_back(faces.size());
+    }
+    // order the queens so that each comes after every queen whose king's
+    // boundary contains it (flow pops queens in such an order, by priority,
+    // but ties in priority are broken as they arise)
+    std::vector<Integer> order;
+    for ( Integer q = 0; q < Q; ++ q ) if ( incoming[q] == 0 ) order.push_back(q);
+    for ( Integer i = 0; i < (Integer) order.size(); ++ i ) {
+      Integer q = order[i];
+      for ( Integer k = offsets[q]; k < offsets[q+1]; ++ k ) {
+        Integer x = faces[k];
+        if ( x != queens[q] && queen[x] != -1 && -- incoming[queen[x]] == 0 ) order.push_back(queen[x]);
+      }
+    }
+    if ( (Integer) order.size() != Q ) return false;
+    // the columns are independent, so each thread clears all of the
+    // queens in its own words (polling progress as it goes)
+    Integer W = rows.words();
+    parallel_for_blocks(0, W, [&](Integer wb, Integer we){
+      std::vector<uint64_t> sum ( we - wb );
+      for ( Integer i = 0; i < Q; ++ i ) {
+        report_progress("boundary", first + (C * i) / Q, size());
+        Integer q = order[i];
+        uint64_t const* row = rows.row(queens[q]) + wb;
+        if ( std::all_of(row, row + (we - wb), [](uint64_t x){ return x == 0; }) ) continue;
+        std::copy(row, row + (we - wb), sum.begin());
+        for ( Integer k = offsets[q]; k < offsets[q+1]; ++ k ) {
+          uint64_t * target = rows.row(faces[k]) + wb;
+          for ( Integer x = 0; x < we - wb; ++ x ) target[x] ^= sum[x];
+        }
+      }
+    }, 4);
+    // project onto the critical cells of dimension d
+    for ( auto ace : (*this)(d) ) {
+      rows.for_each(include_[ace] - row_begin, [&](Integer j){ bd[first + j] += ace; });
+    }
+    Instrumentation::instance().add("dense boundary blocks", 1);
+    return true;
+  }
+
+  /// reindex_
+  ///   Set up include_ and project_ from the matching's reindexing.
+  ///   Critical cells usually come in increasing order, and then
+  ///   project_cell_ searches include_ rather than keeping a hash table.
+  void
+  reindex_ ( MorseMatching::ReindexType const& reindex ) {
+    Integer N = reindex.size();
+    include_.assign(N, 0, base_ -> size());
+    bool numbered = true;
+    for ( Integer i = 0; i < N; ++ i ) {
+      include_.set(i, reindex[i].first);
+      if ( reindex[i].second != i ) numbered = false;
+    }
+    if ( not numbered || not include_.is_sorted() ) {
+      project_ = std::unordered_map<Integer, Integer>(reindex.begin(), reindex.end());
+    }
+  }
+
+  /// project_cell_
+  ///   Critical cell number of base cell x, or -1 if x is not critical
+  Integer
+  project_cell_ ( Integer x ) const {
+    if ( project_.empty() ) {
+      Integer i = include_.lower_bound(x);
+      return ( i < include_.size() && include_[i] == x ) ? i : -1;
+    }
+    auto it = project_.find(x);
+    return ( it == project_.end() ) ? -1 : it -> second;
+  }
+
   std::shared_ptr<Complex> base_;
   std::shared_ptr<MorseMatching> matching_;
-  std::vector<Integer> include_;
+  IndexArray include_;
   std::unordered_map<Integer, Integer> project_;
-  std::vector<Chain> bd_;
-  std::vector<Chain> cbd_;
+  CompressedChains bd_;
+  CompressedChains cbd_;
 };
 
 
@@ -202,8 +370,20 @@ namespace py = pybind11;
 inline void
 MorseComplexBinding(py::module &m) {
   py::class_<MorseComplex, std::shared_ptr<MorseComplex>, Complex>(m, "MorseComplex")
-    .def(py::init<std::shared_ptr<Complex>, std::shared_ptr<MorseMatching>>())
-    .def(py::init<std::shared_ptr<Complex>>())
+    .def(py::init([](std::shared_ptr<Complex> base, std::shared_ptr<MorseMatching> matching,
+                     py::object progress, std::shared_ptr<CancellationToken> token, double interval) {
+       return with_progress(progress, token, interval, [&](){
+         return std::make_shared<MorseComplex>(base, matching);
+       });
+     }), py::arg("base"), py::arg("matching"), py::arg("progress") = py::none(),
+         py::arg("token") = py::none(), py::arg("interval") = 0.1)
+    .def(py::init([](std::shared_ptr<Complex> base, py::object progress,
+                     std::shared_ptr<CancellationToken> token, double interval) {
+       return with_progress(progress, token, interval, [&](){
+         return std::make_shared<MorseComplex>(base);
+       });
+     }), py::arg("base"), py::arg("progress") = py::none(),
+         py::arg("token") = py::none(), py::arg("interval") = 0.1)
     .def("include", &MorseComplex::include)
     .def("project", &MorseComplex::project)
     .def("lift", &MorseComplex::lift)
@@ -14,6 +14,9 @@
 #include "MorseComplex.h"
 #include "MorseMatching.h"
 #include "GradedComplex.h"
+#include "Progress.h"
+#include "Instrumentation.h"
+#include "ResultCache.h"
 
 /// MorseGradedComplex
 inline
@@ -24,21 +27,26 @@ MorseGradedComplex ( std::shared_ptr<GradedComplex> base_graded_complex,
   std::shared_ptr<MorseComplex> complex ( new MorseComplex(base_graded_complex -> complex(), matching) );
 
   // Convert indices of cells to compute new graded_complex mapping (map from cell index to poset vertex number)
+  StageTimer timer ( "grading" );
   std::vector<Integer> graded_complex_mapping(complex -> size());
   for ( auto x : *complex ) {
+    report_progress("grading", x, complex -> size());
     Chain included = complex -> include ({x});
     graded_complex_mapping[x]= base_graded_complex -> value(*included.begin());
   }
 
-  return std::shared_ptr<GradedComplex>( new GradedComplex(complex, [=](Integer x){return graded_complex_mapping[x];}));
+  return std::make_shared<GradedComplex>(complex, std::move(graded_complex_mapping));
 }
 
 /// MorseGradedComplex
 inline
 std::shared_ptr<GradedComplex> 
 MorseGradedComplex ( std::shared_ptr<GradedComplex> base_graded_complex ) {
-  std::shared_ptr<MorseMatching> matching ( MorseMatching::compute_matching(base_graded_complex) );
-  return MorseGradedComplex (base_graded_complex, matching);
+  return ResultCache::instance().fetch<GradedComplex>(ResultCache::MORSE_GRADED_COMPLEX,
+    base_graded_complex -> complex(), base_graded_complex, [&](){
+    std::shared_ptr<MorseMatching> matching ( MorseMatching::compute_matching(base_graded_complex) );
+    return MorseGradedComplex (base_graded_complex, matching);
+  });
 }
 
 /// Python Bindings
@@ -49,6 +57,18 @@ namespace py = pybind11;
 
 inline
 void MorseGradedComplexBinding(py::module &m) {
-  m.def("MorseGradedComplex", (std::shared_ptr<GradedComplex>(*)(std::shared_ptr<GradedComplex>,std::shared_ptr<MorseMatching>))&MorseGradedComplex);
-  m.def("MorseGradedComplex", (std::shared_ptr<GradedComplex>(*)(std::shared_ptr<GradedComplex>))&MorseGradedComplex);
+  m.def("MorseGradedComplex", [](std::shared_ptr<GradedComplex> base, std::shared_ptr<MorseMatching> matching,
+                                 py::object progress, std::shared_ptr<CancellationToken> token, double interval) {
+    return with_progress(progress, token, interval, [&](){
+      return MorseGradedComplex(base, matching);
+    });
+  }, py::arg("base"), py::arg("matching"), py::arg("progress") = py::none(),
+     py::arg("token") = py::none(), py::arg("interval") = 0.1);
+  m.def("MorseGradedComplex", [](std::shared_ptr<GradedComplex> base,
+                                 py::object progress, std::shared_ptr<CancellationToken> token, double interval) {
+    return with_progress(progress, token, interval, [&](){
+      return MorseGradedComplex(base);
+    });
+  }, py::arg("base"), py::arg("progress") = py::none(),
+     py::arg("token") = py::none(), py::arg("interval") = 0.1);
 }
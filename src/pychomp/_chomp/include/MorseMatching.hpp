@@ -6,23 +6,45 @@
 #include "MorseMatching.h"
 #include "CubicalMorseMatching.h"
 #include "GenericMorseMatching.h"
+#include "ResultCache.h"
+
+/// dual_of_acyclic_cubical_
+///   True if complex is the dual of a non-periodic CubicalComplex
+///   (see DualCubicalMorseMatching)
+inline bool
+dual_of_acyclic_cubical_ ( std::shared_ptr<Complex> complex ) {
+  auto dual = std::dynamic_pointer_cast<DualComplex>(complex);
+  if ( not dual ) return false;
+  auto cubical = std::dynamic_pointer_cast<CubicalComplex>(dual -> base());
+  return cubical && not cubical -> periodic();
+}
 
 inline
 std::shared_ptr<MorseMatching>
 MorseMatching::compute_matching ( std::shared_ptr<Complex> complex ) {
-  if ( std::dynamic_pointer_cast<CubicalComplex>(complex) ) {
-    return std::make_shared<CubicalMorseMatching>(std::dynamic_pointer_cast<CubicalComplex>(complex));
-  } else {
-    return std::make_shared<GenericMorseMatching>(complex);
-  }
+  return ResultCache::instance().fetch<MorseMatching>(ResultCache::MATCHING, complex, nullptr,
+    [&]() -> std::shared_ptr<MorseMatching> {
+    if ( std::dynamic_pointer_cast<CubicalComplex>(complex) ) {
+      return std::make_shared<CubicalMorseMatching>(std::dynamic_pointer_cast<CubicalComplex>(complex));
+    } else if ( dual_of_acyclic_cubical_(complex) ) {
+      return std::make_shared<DualCubicalMorseMatching>(std::dynamic_pointer_cast<DualComplex>(complex));
+    } else {
+      return std::make_shared<GenericMorseMatching>(complex);
+    }
+  });
 }
 
 inline
 std::shared_ptr<MorseMatching>
 MorseMatching::compute_matching ( std::shared_ptr<GradedComplex> graded_complex ) {
-  if ( std::dynamic_pointer_cast<CubicalComplex>(graded_complex->complex()) ) {
-    return std::make_shared<CubicalMorseMatching>(graded_complex);
-  } else {
-    return std::make_shared<GenericMorseMatching>(graded_complex);
-  }
+  return ResultCache::instance().fetch<MorseMatching>(ResultCache::MATCHING, graded_complex->complex(), graded_complex,
+    [&]() -> std::shared_ptr<MorseMatching> {
+    if ( std::dynamic_pointer_cast<CubicalComplex>(graded_complex->complex()) ) {
+      return std::make_shared<CubicalMorseMatching>(graded_complex);
+    } else if ( dual_of_acyclic_cubical_(graded_complex->complex()) ) {
+      return std::make_shared<DualCubicalMorseMatching>(graded_complex);
+    } else {
+      return std::make_shared<GenericMorseMatching>(graded_complex);
+    }
+  });
 }
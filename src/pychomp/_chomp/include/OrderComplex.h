@@ -6,31 +6,300 @@
 #pragma once
 
 #include "common.h"
+#include "IndexArray.h"
+#include "Parallel.h"
 #include "SimplicialComplex.h"
 
-std::shared_ptr<SimplicialComplex>
-OrderComplex ( std::shared_ptr<Complex> c ) {
-  std::vector<Simplex> simplices;
-  std::stack<Simplex> work_stack;
-  for ( auto i : *c ) {
-    work_stack.push({i});
-    while ( not work_stack.empty() ) {
-      Simplex s = work_stack.top();
-      work_stack.pop();
-      auto v = s.back();
-      auto bd = c -> boundary({v});
-      for ( auto u : bd ) {
-        Simplex t = s;
-        t.push_back(u);
-        work_stack.push(t);
+/// ImplicitOrderComplex
+///   Order complex of the face poset of a complex, with simplices
+///   computed on demand rather than stored. A k-simplex is a chain
+///   v_0 < v_1 < ... < v_k of cells, each a face of the next (so the
+///   cell indices increase). Simplices are numbered by dimension, then
+///   lexicographically, exactly as in OrderComplex(c).
+///   Only the number of k-chains starting at each cell is stored, as
+///   prefix sums over the cells (dimension+2 Integers per cell). The
+///   faces and cofaces of a cell are found when needed by closing its
+///   boundary or coboundary in the base complex. Together these rank and
+///   unrank chains, from which column and row are computed.
+class ImplicitOrderComplex : public Complex {
+public:
+
+  /// ImplicitOrderComplex
+  ImplicitOrderComplex ( std::shared_ptr<Complex> c );
+
+  /// column
+  ///   Apply "callback" method to every element in ith column of
+  ///   boundary matrix
+  virtual void
+  column ( Integer i, std::function<void(Integer)> const& callback) const final;
+
+  /// row
+  ///   Apply "callback" method to every element in ith row of
+  ///   boundary matrix
+  virtual void
+  row ( Integer i, std::function<void(Integer)> const& callback) const final;
+
+  /// simplex
+  ///   The chain of cells of the base complex with index i
+  Simplex
+  simplex ( Integer i ) const;
+
+  /// idx
+  ///   Index of a chain of cells of the base complex (in any order), or
+  ///   -1 if they do not form a chain
+  Integer
+  idx ( Simplex const& s ) const;
+
+  /// base
+  std::shared_ptr<Complex>
+  base ( void ) const {
+    return c_;
+  }
+
+  /// simplicial_complex
+  ///   Materialize as a SimplicialComplex (with the same cell indices).
+  ///   Each cell's chains are written straight to their positions, so
+  ///   nothing beyond the result is stored.
+  std::shared_ptr<SimplicialComplex>
+  simplicial_complex ( void ) const;
+
+  /// memory
+  ///   Bytes used by the chain counts
+  Integer
+  memory ( void ) const {
+    Integer result = 0;
+    for ( auto const& p : prefix_ ) result += sizeof(Integer) * p.size();
+    return result;
+  }
+
+private:
+  std::shared_ptr<Complex> c_;
+  std::vector<std::vector<Integer>> prefix_;
+
+  /// count_
+  ///   Number of k-chains with least cell v
+  Integer
+  count_ ( Integer v, Integer k ) const {
+    return prefix_[k][v+1] - prefix_[k][v];
+  }
+
+  /// closure_
+  ///   Sorted proper cofaces (if up) or faces of v in the base complex,
+  ///   found one dimension at a time from its coboundary (boundary)
+  void
+  closure_ ( Integer v, bool up, std::vector<Integer> & result ) const;
+
+  /// rank_
+  ///   Index of the chain s[0] < ... < s[k], or -1 if it is not a chain
+  Integer
+  rank_ ( Integer const* s, Integer k ) const;
+
+  /// unrank_
+  ///   Chain with index i
+  void
+  unrank_ ( Integer i, Simplex & s ) const;
+};
+
+inline ImplicitOrderComplex::
+ImplicitOrderComplex ( std::shared_ptr<Complex> c ) : c_(c) {
+  Integer N = c -> size();
+  Integer D = c -> dimension();
+  // Number of k-chains with least cell v: one for k = 0, otherwise the
+  // sum over the cofaces u of v of the (k-1)-chains with least cell u.
+  // Cells are handled by decreasing dimension, so the counts of the
+  // cofaces are already known.
+  prefix_.resize(std::max<Integer>(D+1, 0));
+  for ( auto & p : prefix_ ) p.assign(N+1, 0);
+  Integer e = N;
+  for ( Integer d = D; d >= 0; -- d ) {
+    Integer b = e - c -> size(d);
+    parallel_for_blocks(b, e, [&](Integer vb, Integer ve){
+      std::vector<Integer> up;
+      for ( Integer v = vb; v < ve; ++ v ) {
+        closure_(v, true, up);
+        prefix_[0][v] = 1;
+        for ( Integer k = 1; k <= D; ++ k ) {
+          Integer total = 0;
+          for ( auto u : up ) total += prefix_[k-1][u];
+          prefix_[k][v] = total;
+        }
       }
-      if ( bd.size() == 0 ) {
-        simplices.push_back(s);
+    }, 256);
+    e = b;
+  }
+  dim_ = -1;
+  for ( Integer k = 0; k <= D; ++ k ) {
+    if ( std::all_of(prefix_[k].begin(), prefix_[k].end(), [](Integer x){ return x == 0; }) ) break;
+    dim_ = k;
+  }
+  prefix_.resize(dim_ + 1);
+  begin_.clear();
+  Integer total = 0;
+  for ( Integer k = 0; k <= dim_; ++ k ) {
+    begin_.push_back(Iterator(total));
+    total += parallel_exclusive_scan(prefix_[k]);
+  }
+  begin_.push_back(Iterator(total));
+}
+
+inline void ImplicitOrderComplex::
+closure_ ( Integer v, bool up, std::vector<Integer> & result ) const {
+  result.clear();
+  std::vector<Integer> level ( 1, v ), next;
+  while ( not level.empty() ) {
+    next.clear();
+    for ( auto x : level ) {
+      Chain adjacent = up ? c_ -> coboundary({x}) : c_ -> boundary({x});
+      for ( auto y : adjacent ) next.push_back(y);
+    }
+    std::sort(next.begin(), next.end());
+    next.erase(std::unique(next.begin(), next.end()), next.end());
+    result.insert(result.end(), next.begin(), next.end());
+    std::swap(level, next);
+  }
+  std::sort(result.begin(), result.end());
+}
+
+inline Integer ImplicitOrderComplex::
+rank_ ( Integer const* s, Integer k ) const {
+  // chains starting below s[0], then for each i those which agree with
+  // s before position i and have a smaller cell at position i
+  Integer r = prefix_[k][s[0]];
+  std::vector<Integer> up;
+  for ( Integer i = 1; i <= k; ++ i ) {
+    closure_(s[i-1], true, up);
+    Integer p = 0, end = up.size();
+    for ( ; p < end && up[p] < s[i]; ++ p ) r += count_(up[p], k-i);
+    if ( p == end || up[p] != s[i] ) return -1;
+  }
+  return *begin_[k] + r;
+}
+
+inline void ImplicitOrderComplex::
+unrank_ ( Integer i, Simplex & s ) const {
+  Integer k = 0;
+  while ( *begin_[k+1] <= i ) ++ k;
+  Integer r = i - *begin_[k];
+  s.resize(k+1);
+  s[0] = std::upper_bound(prefix_[k].begin(), prefix_[k].end(), r) - prefix_[k].begin() - 1;
+  r -= prefix_[k][s[0]];
+  std::vector<Integer> up;
+  for ( Integer j = 1; j <= k; ++ j ) {
+    closure_(s[j-1], true, up);
+    for ( Integer p = 0; ; ++ p ) {
+      Integer c = count_(up[p], k-j);
+      if ( r < c ) {
+        s[j] = up[p];
+        break;
       }
+      r -= c;
     }
   }
-  std::shared_ptr<SimplicialComplex> oc ( new SimplicialComplex(simplices) );
-  return oc;
+}
+
+inline void ImplicitOrderComplex::
+column ( Integer i, std::function<void(Integer)> const& callback ) const {
+  Simplex s, t;
+  unrank_(i, s);
+  Integer k = s.size() - 1;
+  if ( k == 0 ) return;
+  // dropping cells from last to first gives the faces in increasing order
+  for ( Integer j = k; j >= 0; -- j ) {
+    t = s;
+    t.erase(t.begin() + j);
+    callback(rank_(t.data(), k-1));
+  }
+}
+
+inline void ImplicitOrderComplex::
+row ( Integer i, std::function<void(Integer)> const& callback ) const {
+  Simplex s, t;
+  unrank_(i, s);
+  Integer k = s.size() - 1;
+  if ( k + 1 > dim_ ) return;
+  std::vector<Integer> result;
+  auto insert = [&](Integer j, Integer u){
+    t = s;
+    t.insert(t.begin() + j, u);
+    result.push_back(rank_(t.data(), k+1));
+  };
+  // a cell below s[0], between s[j-1] and s[j], or above s[k]
+  std::vector<Integer> down, up;
+  closure_(s[0], false, down);
+  for ( auto u : down ) insert(0, u);
+  for ( Integer j = 1; j <= k; ++ j ) {
+    closure_(s[j], false, down);
+    closure_(s[j-1], true, up);
+    std::vector<Integer> between;
+    std::set_intersection(down.begin(), down.end(), up.begin(), up.end(), std::back_inserter(between));
+    for ( auto u : between ) insert(j, u);
+  }
+  closure_(s[k], true, up);
+  for ( auto u : up ) insert(k+1, u);
+  std::sort(result.begin(), result.end());
+  for ( auto x : result ) callback(x);
+}
+
+inline Simplex ImplicitOrderComplex::
+simplex ( Integer i ) const {
+  Simplex s;
+  unrank_(i, s);
+  return s;
+}
+
+inline Integer ImplicitOrderComplex::
+idx ( Simplex const& s ) const {
+  Simplex t = s;
+  std::sort(t.begin(), t.end());
+  Integer k = (Integer) t.size() - 1;
+  if ( k < 0 || k > dim_ || t.front() < 0 || t.back() >= c_ -> size() ) return -1;
+  return rank_(t.data(), k);
+}
+
+inline std::shared_ptr<SimplicialComplex> ImplicitOrderComplex::
+simplicial_complex ( void ) const {
+  Integer N = c_ -> size();
+  std::vector<IndexArray> vertices;
+  for ( Integer k = 0; k <= dim_; ++ k ) vertices.emplace_back(size(k) * (k+1), 0, N);
+  // Depth-first search from each least cell v in lexicographic order,
+  // so its k-chains fill the positions prefix_[k][v], ... in order;
+  // up[k] holds the cofaces of chain[k]
+  parallel_for_blocks(0, N, [&](Integer b, Integer e){
+    std::vector<Integer> chain ( dim_ + 1 ), next ( dim_ + 1 ), cursor ( dim_ + 1 );
+    std::vector<std::vector<Integer>> up ( dim_ + 1 );
+    auto emit = [&](Integer k){
+      for ( Integer t = 0; t <= k; ++ t ) vertices[k].set(cursor[k] * (k+1) + t, chain[t]);
+      ++ cursor[k];
+    };
+    for ( Integer v = b; v < e; ++ v ) {
+      for ( Integer k = 0; k <= dim_; ++ k ) cursor[k] = prefix_[k][v];
+      Integer k = 0;
+      chain[0] = v;
+      next[0] = 0;
+      if ( dim_ > 0 ) closure_(v, true, up[0]);
+      emit(0);
+      while ( k >= 0 ) {
+        if ( k == dim_ || next[k] == (Integer) up[k].size() ) {
+          -- k;
+          continue;
+        }
+        Integer u = up[k][next[k]++];
+        chain[++k] = u;
+        next[k] = 0;
+        if ( k < dim_ ) closure_(u, true, up[k]);
+        emit(k);
+      }
+    }
+  }, 256);
+  return std::make_shared<SimplicialComplex>(std::move(vertices));
+}
+
+/// OrderComplex
+///   Order complex of the face poset of c (its barycentric subdivision)
+///   as a SimplicialComplex whose vertices are the cells of c
+inline std::shared_ptr<SimplicialComplex>
+OrderComplex ( std::shared_ptr<Complex> c ) {
+  return ImplicitOrderComplex(c).simplicial_complex();
 }
 
 /// Python Bindings
@@ -42,4 +311,11 @@ namespace py = pybind11;
 inline void
 OrderComplexBinding(py::module &m) {
   m.def("OrderComplex", &OrderComplex);
+  py::class_<ImplicitOrderComplex, std::shared_ptr<ImplicitOrderComplex>, Complex>(m, "ImplicitOrderComplex")
+    .def(py::init<std::shared_ptr<Complex>>())
+    .def("simplex", &ImplicitOrderComplex::simplex)
+    .def("idx", &ImplicitOrderComplex::idx)
+    .def("base", &ImplicitOrderComplex::base)
+    .def("simplicial_complex", &ImplicitOrderComplex::simplicial_complex)
+    .def("memory", &ImplicitOrderComplex::memory);
 }
@@ -0,0 +1,180 @@
+/// Parallel.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "Integer.h"
+#include "Progress.h"
+
+/// num_threads
+///   Number of worker threads used by parallel_for.
+///   Defaults to std::thread::hardware_concurrency().
+inline std::atomic<Integer> &
+num_threads_ ( void ) {
+  static std::atomic<Integer> n ( std::max<Integer>(1, std::thread::hardware_concurrency()) );
+  return n;
+}
+
+/// thread_budget_
+///   Limit on num_threads() for the calling thread (0 for none)
+inline Integer &
+thread_budget_ ( void ) {
+  static thread_local Integer budget = 0;
+  return budget;
+}
+
+inline Integer
+num_threads ( void ) {
+  Integer n = num_threads_ ();
+  Integer budget = thread_budget_ ();
+  return budget > 0 ? std::min(n, budget) : n;
+}
+
+inline void
+set_num_threads ( Integer n ) {
+  num_threads_ () = std::max<Integer>(1, n);
+}
+
+/// ThreadBudget
+///   Limits num_threads() on the calling thread while in scope, e.g. for
+///   workers which each run a whole computation of their own
+class ThreadBudget {
+public:
+  ThreadBudget ( Integer n ) : previous_(thread_budget_ ()) {
+    thread_budget_ () = std::max<Integer>(1, n);
+  }
+
+  ~ThreadBudget ( void ) {
+    thread_budget_ () = previous_;
+  }
+
+private:
+  Integer previous_;
+};
+
+/// parallel_for_blocks
+///   Split [begin, end) into contiguous blocks and call f(block_begin, block_end)
+///   once per block, using up to num_threads() threads. Ranges smaller than
+///   grain are run on the calling thread. Workers run with the caller's
+///   progress monitor installed, so they poll it (and can be cancelled).
+///   The first exception thrown by a worker is rethrown on the calling
+///   thread after all workers have joined.
+template < typename F >
+void
+parallel_for_blocks ( Integer begin, Integer end, F const& f, Integer grain = 4096 ) {
+  Integer N = end - begin;
+  if ( N <= 0 ) return;
+  Integer T = std::min<Integer>(num_threads(), (N + grain - 1) / grain);
+  if ( T <= 1 ) {
+    f(begin, end);
+    return;
+  }
+  std::vector<std::thread> workers;
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  ProgressMonitor * monitor = current_progress_monitor ();
+  for ( Integer t = 0; t < T; ++ t ) {
+    Integer b = begin + (N * t) / T;
+    Integer e = begin + (N * (t+1)) / T;
+    workers.emplace_back([&, b, e](){
+      try {
+        ProgressScope scope ( monitor );
+        f(b, e);
+      } catch ( ... ) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if ( not error ) error = std::current_exception();
+      }
+    });
+  }
+  for ( auto & worker : workers ) worker.join();
+  if ( error ) std::rethrow_exception(error);
+}
+
+/// parallel_for
+///   Call f(i) for every i in [begin, end) using up to num_threads() threads
+template < typename F >
+void
+parallel_for ( Integer begin, Integer end, F const& f, Integer grain = 4096 ) {
+  parallel_for_blocks(begin, end, [&](Integer b, Integer e){
+    for ( Integer i = b; i < e; ++ i ) f(i);
+  }, grain);
+}
+
+/// parallel_exclusive_scan
+///   Replace v[0..N) with its exclusive prefix sums and return the total
+inline Integer
+parallel_exclusive_scan ( std::vector<Integer> & v ) {
+  Integer N = v.size();
+  Integer T = std::min<Integer>(num_threads(), std::max<Integer>(1, N / 65536));
+  std::vector<Integer> partial(T+1, 0);
+  parallel_for_blocks(0, T, [&](Integer tb, Integer te){
+    for ( Integer t = tb; t < te; ++ t ) {
+      Integer b = (N * t) / T, e = (N * (t+1)) / T;
+      Integer s = 0;
+      for ( Integer i = b; i < e; ++ i ) s += v[i];
+      partial[t+1] = s;
+    }
+  }, 1);
+  std::partial_sum(partial.begin(), partial.end(), partial.begin());
+  parallel_for_blocks(0, T, [&](Integer tb, Integer te){
+    for ( Integer t = tb; t < te; ++ t ) {
+      Integer b = (N * t) / T, e = (N * (t+1)) / T;
+      Integer s = partial[t];
+      for ( Integer i = b; i < e; ++ i ) {
+        Integer x = v[i];
+        v[i] = s;
+        s += x;
+      }
+    }
+  }, 1);
+  return partial[T];
+}
+
+/// parallel_sort
+///   Sort [first, last) with comp: blocks are sorted in parallel and then
+///   merged pairwise, the merges of each round running in parallel.
+///   Not stable. Ranges smaller than grain are sorted on the calling thread.
+template < typename Iterator, typename Compare >
+void
+parallel_sort ( Iterator first, Iterator last, Compare const& comp, Integer grain = 65536 ) {
+  Integer N = last - first;
+  Integer T = std::min<Integer>(num_threads(), std::max<Integer>(1, N / grain));
+  if ( T <= 1 ) {
+    std::sort(first, last, comp);
+    return;
+  }
+  auto bound = [&](Integer t){ return first + (N * std::min(t, T)) / T; };
+  parallel_for_blocks(0, T, [&](Integer tb, Integer te){
+    for ( Integer t = tb; t < te; ++ t ) std::sort(bound(t), bound(t+1), comp);
+  }, 1);
+  for ( Integer width = 1; width < T; width *= 2 ) {
+    Integer merges = (T + 2*width - 1) / (2*width);
+    parallel_for_blocks(0, merges, [&](Integer mb, Integer me){
+      for ( Integer m = mb; m < me; ++ m ) {
+        Integer t = 2 * width * m;
+        if ( t + width < T ) std::inplace_merge(bound(t), bound(t+width), bound(t+2*width), comp);
+      }
+    }, 1);
+  }
+}
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+namespace py = pybind11;
+
+inline void
+ParallelBinding(py::module &m) {
+  m.def("num_threads", &num_threads);
+  m.def("set_num_threads", &set_num_threads);
+}
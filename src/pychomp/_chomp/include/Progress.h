@@ -0,0 +1,225 @@
+/// Progress.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+
+#include "Integer.h"
+
+/// Cancelled
+///   Thrown out of a computation which has been cancelled
+class Cancelled : public std::runtime_error {
+public:
+  Cancelled ( void ) : std::runtime_error("computation cancelled") {}
+};
+
+/// CancellationToken
+///   Flag shared between a computation and whoever may want to stop it.
+///   Safe to set from any thread.
+class CancellationToken {
+public:
+  CancellationToken ( void ) : cancelled_(false) {}
+
+  /// cancel
+  void
+  cancel ( void ) {
+    cancelled_ = true;
+  }
+
+  /// reset
+  void
+  reset ( void ) {
+    cancelled_ = false;
+  }
+
+  /// cancelled
+  bool
+  cancelled ( void ) const {
+    return cancelled_;
+  }
+
+private:
+  std::atomic<bool> cancelled_;
+};
+
+/// ProgressMonitor
+///   Observer of long-running computations. The algorithms record how far
+///   they are (see report_progress) and every so often call poll, which may
+///   throw (e.g. Cancelled) to abort the computation.
+class ProgressMonitor {
+public:
+  virtual
+  ~ProgressMonitor ( void ) {}
+
+  /// poll
+  ///   stage : name of the current stage
+  ///   done, total : amount of work done out of total in this stage
+  virtual void
+  poll ( char const* stage, Integer done, Integer total ) = 0;
+};
+
+/// ProgressState
+///   Per-thread record of the installed monitor and the latest report
+struct ProgressState {
+  ProgressMonitor * monitor = nullptr;
+  uint64_t ticks = 0;
+  char const* stage = "";
+  Integer done = 0;
+  Integer total = 0;
+};
+
+inline ProgressState &
+progress_state_ ( void ) {
+  static thread_local ProgressState state;
+  return state;
+}
+
+/// check_progress
+///   Called from inner loops. Does nothing unless a monitor is installed
+///   on this thread, in which case the monitor is polled every 1024 calls.
+inline void
+check_progress ( void ) {
+  ProgressState & state = progress_state_ ();
+  if ( state.monitor == nullptr ) return;
+  if ( (++ state.ticks & 1023) != 0 ) return;
+  state.monitor -> poll(state.stage, state.done, state.total);
+}
+
+/// report_progress
+///   Record progress in the current stage, then check_progress
+inline void
+report_progress ( char const* stage, Integer done, Integer total ) {
+  ProgressState & state = progress_state_ ();
+  if ( state.monitor == nullptr ) return;
+  state.stage = stage;
+  state.done = done;
+  state.total = total;
+  check_progress ();
+}
+
+/// poll_progress
+///   Record progress in the current stage and poll the monitor now, for
+///   coarse steps (e.g. one per tile) which are too few for check_progress
+inline void
+poll_progress ( char const* stage, Integer done, Integer total ) {
+  ProgressState & state = progress_state_ ();
+  if ( state.monitor == nullptr ) return;
+  state.stage = stage;
+  state.done = done;
+  state.total = total;
+  state.monitor -> poll(stage, done, total);
+}
+
+/// current_progress_monitor
+///   The monitor installed on this thread (or nullptr), to be installed
+///   on worker threads with ProgressScope
+inline ProgressMonitor *
+current_progress_monitor ( void ) {
+  return progress_state_ () . monitor;
+}
+
+/// ProgressScope
+///   Install a monitor on the current thread for the lifetime of the scope
+class ProgressScope {
+public:
+  ProgressScope ( ProgressMonitor * monitor ) {
+    ProgressState & state = progress_state_ ();
+    previous_ = state.monitor;
+    state.monitor = monitor;
+  }
+
+  ~ProgressScope ( void ) {
+    progress_state_ () . monitor = previous_;
+  }
+
+private:
+  ProgressMonitor * previous_;
+};
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+namespace py = pybind11;
+
+/// PythonProgressMonitor
+///   Checks a CancellationToken on every poll. At most once per "interval"
+///   seconds it takes the GIL, raises KeyboardInterrupt if a signal is
+///   pending, and calls progress(stage, done, total) if given. May be
+///   polled from several threads at once (see parallel_for_blocks); a poll
+///   made while another thread is calling back only checks the token.
+///   Python only delivers signals to the main thread, so when the monitor
+///   is created on another Python thread KeyboardInterrupt is not seen
+///   here; cancel the token instead (e.g. from the main thread's handler).
+///   In that case the GIL is only taken when there is a progress callback.
+class PythonProgressMonitor : public ProgressMonitor {
+public:
+  PythonProgressMonitor ( py::object progress,
+                          std::shared_ptr<CancellationToken> token,
+                          double interval )
+    : progress_(progress), has_progress_(not progress.is_none()), token_(token),
+      interval_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval))),
+      next_(std::chrono::steady_clock::now() + interval_) {
+    py::object threading = py::module::import("threading");
+    main_thread_ = threading.attr("current_thread")().is(threading.attr("main_thread")());
+  }
+
+  virtual void
+  poll ( char const* stage, Integer done, Integer total ) final {
+    if ( token_ && token_ -> cancelled() ) throw Cancelled();
+    std::unique_lock<std::mutex> lock ( mutex_, std::try_to_lock );
+    if ( not lock.owns_lock() ) return;
+    auto now = std::chrono::steady_clock::now();
+    if ( now < next_ ) return;
+    if ( main_thread_ || has_progress_ ) {
+      py::gil_scoped_acquire acquire;
+      if ( main_thread_ && PyErr_CheckSignals() != 0 ) throw py::error_already_set();
+      if ( has_progress_ ) progress_(stage, done, total);
+    }
+    next_ = std::chrono::steady_clock::now() + interval_;
+  }
+
+private:
+  py::object progress_;
+  bool has_progress_;
+  bool main_thread_;
+  std::shared_ptr<CancellationToken> token_;
+  std::chrono::steady_clock::duration interval_;
+  std::chrono::steady_clock::time_point next_;
+  std::mutex mutex_;
+};
+
+/// with_progress
+///   Call f() with the GIL released and a PythonProgressMonitor installed.
+///   Python callables reached from f (e.g. a grading given as a Python
+///   function) take the GIL back for the duration of each call, as does
+///   the monitor when it calls back or checks for signals (see above).
+template < typename F >
+auto
+with_progress ( py::object progress,
+                std::shared_ptr<CancellationToken> token,
+                double interval,
+                F const& f ) -> decltype(f()) {
+  PythonProgressMonitor monitor ( progress, token, interval );
+  ProgressScope scope ( &monitor );
+  py::gil_scoped_release release;
+  return f();
+}
+
+inline void
+ProgressBinding(py::module &m) {
+  py::register_exception<Cancelled>(m, "Cancelled");
+  py::class_<CancellationToken, std::shared_ptr<CancellationToken>>(m, "CancellationToken")
+    .def(py::init<>())
+    .def("cancel", &CancellationToken::cancel)
+    .def("reset", &CancellationToken::reset)
+    .def("cancelled", &CancellationToken::cancelled);
+}
@@ -0,0 +1,395 @@
+/// ResultCache.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Integer.h"
+#include "Parallel.h"
+#include "Progress.h"
+#include "Complex.h"
+#include "CubicalComplex.h"
+#include "GradedComplex.h"
+#include "MorseMatching.h"
+#include "MorseComplex.h"
+#include "GenericMorseMatching.h"
+#include "CubicalMorseMatching.h"
+
+/// ResultCache
+///   Process-wide cache of matchings, Morse complexes and connection
+///   matrices, shared across calls (and threads). Disabled by default.
+///   Results are keyed by the kind of computation, the structure of the
+///   complex (the boxes and periodicity of a CubicalComplex; other
+///   complexes are never cached) and a hash of the values of a dense
+///   grading. The grading is kept with the entry and its values compared
+///   before a hit is returned, so a hash collision is only a miss.
+///   Least recently used entries are evicted to stay within a byte
+///   budget, counting everything an entry keeps alive (the result, the
+///   matchings and intermediate gradings it refers to, and the grading
+///   of the key); sizes are estimates. Concurrent requests for the same
+///   key wait for a single computation rather than repeating it.
+///   A cached result may refer to a different (but identical) complex
+///   object than the one passed in.
+class ResultCache {
+public:
+
+  /// Kind
+  enum Kind { MATCHING, HOMOLOGY, MORSE_GRADED_COMPLEX, CONNECTION_MATRIX };
+
+  /// Stats
+  struct Stats {
+    Integer hits = 0;
+    Integer misses = 0;
+    Integer evictions = 0;
+    Integer entries = 0;
+    Integer bytes = 0;
+    Integer budget = 0;
+  };
+
+  /// instance
+  static ResultCache &
+  instance ( void ) {
+    static ResultCache cache;
+    return cache;
+  }
+
+  /// enabled
+  bool
+  enabled ( void ) const {
+    return budget_.load(std::memory_order_relaxed) > 0;
+  }
+
+  /// enable
+  ///   Cache up to "budget" bytes of results; 0 disables the cache and
+  ///   discards its contents
+  void
+  enable ( Integer budget ) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = std::max<Integer>(budget, 0);
+    evict_();
+  }
+
+  /// clear
+  ///   Discard all entries (counters are kept)
+  void
+  clear ( void ) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    order_.clear();
+    bytes_ = 0;
+  }
+
+  /// reset_stats
+  void
+  reset_stats ( void ) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    hits_ = misses_ = evictions_ = 0;
+  }
+
+  /// stats
+  Stats
+  stats ( void ) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats result;
+    result.hits = hits_;
+    result.misses = misses_;
+    result.evictions = evictions_;
+    result.entries = entries_.size();
+    result.bytes = bytes_;
+    result.budget = budget_;
+    return result;
+  }
+
+  /// fetch
+  ///   The cached result of "kind" on complex (graded by grading, if not
+  ///   null), or else compute() which is then cached. Falls through to
+  ///   compute() when disabled or when the inputs have no fingerprint.
+  ///   A caller waiting for another thread's computation of the same key
+  ///   polls its progress monitor, so it can be cancelled meanwhile.
+  template < typename T, typename F >
+  std::shared_ptr<T>
+  fetch ( Kind kind, std::shared_ptr<Complex> complex,
+          std::shared_ptr<GradedComplex> grading, F const& compute ) {
+    if ( not enabled() ) return compute();
+    Key key;
+    if ( not key_(kind, complex, grading, key) ) return compute();
+    std::shared_ptr<void> found;
+    std::shared_ptr<GradedComplex> found_grading;
+    std::shared_future<std::shared_ptr<void>> pending;
+    std::promise<std::shared_ptr<void>> promise;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = entries_.find(key);
+      auto p = pending_.find(key);
+      if ( it != entries_.end() ) {
+        order_.splice(order_.begin(), order_, it -> second.position);
+        found = it -> second.result;
+        found_grading = it -> second.grading;
+      } else if ( p != pending_.end() ) {
+        pending = p -> second.result;
+        found_grading = p -> second.grading;
+      } else {
+        ++ misses_;
+        pending_[key] = Pending { promise.get_future().share(), grading };
+      }
+    }
+    if ( found || pending.valid() ) {
+      // the key matched; make sure the grading does too
+      bool same = same_values_(grading, found_grading);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++ ( same ? hits_ : misses_ );
+      }
+      if ( not same ) return compute();
+      if ( found ) return std::static_pointer_cast<T>(found);
+      // another thread is computing it; wait for it, polling the monitor
+      // so that the wait can be cancelled, and if that fails, compute it here
+      while ( pending.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready ) {
+        poll_progress("waiting for cached result", 0, 1);
+      }
+      auto result = std::static_pointer_cast<T>(pending.get());
+      return result ? result : compute();
+    }
+    std::shared_ptr<T> result;
+    try {
+      result = compute();
+    } catch ( ... ) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.erase(key);
+      promise.set_value(nullptr);
+      throw;
+    }
+    Footprint footprint;
+    footprint.add(result);
+    footprint.add(grading);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.erase(key);
+      if ( footprint.bytes <= budget_ && entries_.count(key) == 0 ) {
+        order_.push_front(key);
+        Entry & entry = entries_[key];
+        entry.result = result;
+        entry.grading = grading;
+        entry.bytes = footprint.bytes;
+        entry.position = order_.begin();
+        bytes_ += footprint.bytes;
+        evict_();
+      }
+    }
+    promise.set_value(result);
+    return result;
+  }
+
+  /// grading_hash
+  ///   Hash of the values of a dense grading (the same for any number of
+  ///   threads); false if the grading is not dense
+  static bool
+  grading_hash ( GradedComplex const& grading, uint64_t & result ) {
+    Integer const* values = grading.values();
+    if ( values == nullptr ) return false;
+    Integer N = grading.complex() -> size();
+    Integer const block = 1 << 16;
+    std::vector<uint64_t> hashes ( (N + block - 1) / block );
+    parallel_for(0, hashes.size(), [&](Integer b){
+      uint64_t h = b;
+      for ( Integer i = b * block; i < std::min(N, (b+1) * block); ++ i ) h = mix_(h ^ (uint64_t) values[i]);
+      hashes[b] = h;
+    }, 1);
+    result = N;
+    for ( auto h : hashes ) result = mix_(result ^ h);
+    return true;
+  }
+
+private:
+  ResultCache ( void ) : budget_(0) {}
+
+  /// Key
+  ///   The kind, then the boxes and periodicity of the complex, then
+  ///   (if graded) the grading hash
+  typedef std::vector<Integer> Key;
+
+  struct KeyHash {
+    std::size_t
+    operator () ( Key const& key ) const {
+      uint64_t h = 0;
+      for ( auto x : key ) h = mix_(h ^ (uint64_t) x);
+      return h;
+    }
+  };
+
+  struct Entry {
+    std::shared_ptr<void> result;
+    std::shared_ptr<GradedComplex> grading;
+    Integer bytes;
+    std::list<Key>::iterator position;
+  };
+
+  struct Pending {
+    std::shared_future<std::shared_ptr<void>> result;
+    std::shared_ptr<GradedComplex> grading;
+  };
+
+  std::atomic<Integer> budget_;
+  mutable std::mutex mutex_;
+  std::unordered_map<Key, Entry, KeyHash> entries_;
+  std::unordered_map<Key, Pending, KeyHash> pending_;
+  std::list<Key> order_;
+  Integer bytes_ = 0;
+  Integer hits_ = 0;
+  Integer misses_ = 0;
+  Integer evictions_ = 0;
+
+  /// mix_
+  ///   64-bit finalizer (splitmix64)
+  static uint64_t
+  mix_ ( uint64_t x ) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  /// key_
+  ///   Fingerprint of a computation; false if it cannot be cached
+  static bool
+  key_ ( Kind kind, std::shared_ptr<Complex> complex,
+         std::shared_ptr<GradedComplex> grading, Key & key ) {
+    auto cubical = std::dynamic_pointer_cast<CubicalComplex>(complex);
+    if ( not cubical ) return false;
+    key.assign(1, kind);
+    key.insert(key.end(), cubical -> boxes().begin(), cubical -> boxes().end());
+    key.push_back(cubical -> periodic());
+    if ( grading ) {
+      uint64_t h;
+      if ( not grading_hash(*grading, h) ) return false;
+      key.push_back((Integer) h);
+    }
+    return true;
+  }
+
+  /// evict_
+  ///   Drop least recently used entries until within budget (mutex held)
+  void
+  evict_ ( void ) {
+    while ( bytes_ > budget_ && not order_.empty() ) {
+      auto it = entries_.find(order_.back());
+      bytes_ -= it -> second.bytes;
+      entries_.erase(it);
+      order_.pop_back();
+      ++ evictions_;
+    }
+  }
+
+  /// same_values_
+  ///   Whether two dense gradings of complexes of the same size (or two
+  ///   null gradings) have the same values
+  static bool
+  same_values_ ( std::shared_ptr<GradedComplex> const& a,
+                 std::shared_ptr<GradedComplex> const& b ) {
+    if ( a == b ) return true;
+    if ( not a || not b ) return false;
+    Integer const* x = a -> values();
+    Integer const* y = b -> values();
+    Integer N = a -> complex() -> size();
+    if ( x == y ) return true;
+    if ( x == nullptr || y == nullptr || b -> complex() -> size() != N ) return false;
+    Integer const block = 1 << 16;
+    std::atomic<bool> same ( true );
+    parallel_for(0, (N + block - 1) / block, [&](Integer k){
+      Integer first = k * block, last = std::min(N, (k+1) * block);
+      if ( not std::equal(x + first, x + last, y + first) ) same = false;
+    }, 1);
+    return same;
+  }
+
+  /// Footprint
+  ///   Estimated memory kept alive by a cache entry: every graded
+  ///   complex, Morse complex and matching reachable from it, each
+  ///   counted once. A CubicalComplex is not counted (its tables are
+  ///   small, and the cells are implicit).
+  struct Footprint {
+    Integer bytes = 0;
+    std::unordered_set<void const*> seen;
+
+    void
+    add ( std::shared_ptr<MorseMatching> const& matching ) {
+      if ( not matching || not seen.insert(matching.get()).second ) return;
+      auto critical = matching -> critical_cells();
+      bytes += sizeof(Integer) * critical.first.size() + 2 * sizeof(Integer) * critical.second.size();
+      if ( auto generic = std::dynamic_pointer_cast<GenericMorseMatching>(matching) ) {
+        bytes += generic -> mates().memory() + generic -> priorities().memory();
+      }
+      if ( auto cubical = std::dynamic_pointer_cast<CubicalMorseMatching>(matching) ) {
+        add(cubical -> graded_complex());
+      }
+      if ( auto dual = std::dynamic_pointer_cast<DualCubicalMorseMatching>(matching) ) {
+        add(dual -> graded_complex());
+        add(dual -> primal());
+      }
+    }
+
+    void
+    add ( std::shared_ptr<Complex> const& complex ) {
+      if ( not complex || not seen.insert(complex.get()).second ) return;
+      if ( auto morse = std::dynamic_pointer_cast<MorseComplex>(complex) ) {
+        bytes += morse -> memory();
+        add(morse -> matching());
+        add(morse -> base());
+      }
+    }
+
+    void
+    add ( std::shared_ptr<GradedComplex> const& grading ) {
+      if ( not grading || not seen.insert(grading.get()).second ) return;
+      if ( grading -> values() && seen.insert(grading -> values()).second ) {
+        bytes += sizeof(Integer) * grading -> complex() -> size();
+      }
+      add(grading -> complex());
+    }
+  };
+};
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+namespace py = pybind11;
+
+inline void
+ResultCacheBinding(py::module &m) {
+  m.def("result_cache_enable", [](Integer budget) {
+    ResultCache::instance().enable(budget);
+  }, py::arg("budget") = Integer(1) << 30);
+  m.def("result_cache_enabled", []() {
+    return ResultCache::instance().enabled();
+  });
+  m.def("result_cache_clear", []() {
+    ResultCache::instance().clear();
+  });
+  m.def("result_cache_reset_stats", []() {
+    ResultCache::instance().reset_stats();
+  });
+  m.def("result_cache_stats", []() {
+    // {"hits", "misses", "evictions", "entries", "bytes", "budget"}
+    auto stats = ResultCache::instance().stats();
+    py::dict result;
+    result["hits"] = stats.hits;
+    result["misses"] = stats.misses;
+    result["evictions"] = stats.evictions;
+    result["entries"] = stats.entries;
+    result["bytes"] = stats.bytes;
+    result["budget"] = stats.budget;
+    return result;
+  });
+}
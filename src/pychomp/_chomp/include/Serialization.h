@@ -0,0 +1,683 @@
+/// Serialization.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+/// Versioned binary format for complexes, gradings, matchings and
+/// Morse complexes.
+///
+/// Layout of a serialized object (integers are little-endian whatever
+/// the host; big-endian hosts swap bytes on the way in and out):
+///   header   : magic "PYCHOMP\0", uint32 version, uint32 kind,
+///              uint64 number of sections, uint64 total size in bytes
+///   table    : uint64 offset and uint64 size in bytes of each section
+///   sections : each starts at a multiple of 64 bytes from the start of
+///              the object; a section is either a raw array or a nested
+///              serialized object
+///
+/// Sections by kind:
+///   CubicalComplex       : boxes, [flags] (bit 0 set: non-periodic)
+///   SimplicialComplex    : simplex offsets, simplex vertices (in cell
+///                          order), boundary offsets, boundary entries
+///   GradedComplex        : complex, values (one per cell)
+///   GenericMorseMatching : mate, priority, begin, reindex (flattened pairs)
+///   CubicalMorseMatching : graded complex, begin, reindex
+///   MorseComplex         : base complex, matching,
+///                          boundary offsets, boundary entries
+///
+/// Files are loaded by memory-mapping them. Only the values of a graded
+/// complex are used in place from the mapping (on little-endian hosts), so
+/// processes loading the same file share them; all other arrays (boundaries,
+/// simplices, mates, critical cells), and the values on big-endian hosts,
+/// are copied out of the mapping, and coboundaries are recomputed. A
+/// MorseComplex embeds a full copy of its base complex and matching.
+///
+/// Loading checks that the arrays are consistent (offsets, cell numbers
+/// and mates in range) and throws std::invalid_argument if not.
+
+#pragma once
+
+#include "common.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Integer.h"
+#include "IndexArray.h"
+#include "Complex.h"
+#include "CompressedChains.h"
+#include "CubicalComplex.h"
+#include "SimplicialComplex.h"
+#include "GradedComplex.h"
+#include "MorseMatching.h"
+#include "CubicalMorseMatching.h"
+#include "GenericMorseMatching.h"
+#include "MorseComplex.h"
+
+/// SerialKind
+enum class SerialKind : uint32_t {
+  CubicalComplex = 1,
+  SimplicialComplex = 2,
+  GradedComplex = 3,
+  GenericMorseMatching = 4,
+  CubicalMorseMatching = 5,
+  MorseComplex = 6
+};
+
+/// serialization_version
+///   Version written into new files. Files with a newer version are rejected.
+inline uint32_t
+serialization_version ( void ) {
+  return 1;
+}
+
+/// serial_little_endian_
+///   True if the host byte order is that of the format
+inline bool
+serial_little_endian_ ( void ) {
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+  return __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__;
+#else
+  uint16_t x = 1;
+  char c;
+  std::memcpy(&c, &x, 1);
+  return c == 1;
+#endif
+}
+
+/// serial_swap_
+///   Reverse the bytes of each of the n elements of the given width
+///   in place (a no-op on little-endian hosts)
+inline void
+serial_swap_ ( char * data, uint64_t n, uint64_t width ) {
+  if ( serial_little_endian_() || width == 1 ) return;
+  for ( uint64_t i = 0; i < n; ++ i ) std::reverse(data + i * width, data + (i + 1) * width);
+}
+
+/// Serializer
+///   Collects the sections of one object, then lays them out
+class Serializer {
+public:
+  Serializer ( SerialKind kind ) : kind_(kind) {}
+
+  /// array
+  template < typename T >
+  void
+  array ( T const* data, uint64_t n ) {
+    sections_.emplace_back(reinterpret_cast<char const*>(data), n * sizeof(T));
+    if ( n > 0 ) serial_swap_(&sections_.back()[0], n, sizeof(T));
+  }
+
+  /// array
+  template < typename T >
+  void
+  array ( std::vector<T> const& v ) {
+    array(v.data(), v.size());
+  }
+
+  /// array
+  ///   IndexArrays are written as Integer, whatever their storage
+  void
+  array ( IndexArray const& v ) {
+    array(v.to_vector());
+  }
+
+  /// object
+  ///   Nested serialized object
+  void
+  object ( std::string const& blob ) {
+    sections_.push_back(blob);
+  }
+
+  /// str
+  std::string
+  str ( void ) const {
+    uint64_t S = sections_.size();
+    uint64_t table_offset = 32;
+    uint64_t offset = align_(table_offset + 16 * S);
+    std::vector<uint64_t> table;
+    for ( auto const& section : sections_ ) {
+      table.push_back(offset);
+      table.push_back(section.size());
+      offset = align_(offset + section.size());
+    }
+    std::string result ( offset, '\0' );
+    char * p = &result[0];
+    uint32_t version = serialization_version();
+    uint32_t kind = static_cast<uint32_t>(kind_);
+    std::memcpy(p, "PYCHOMP", 8);
+    std::memcpy(p + 8, &version, 4);
+    std::memcpy(p + 12, &kind, 4);
+    std::memcpy(p + 16, &S, 8);
+    std::memcpy(p + 24, &offset, 8);
+    if ( S > 0 ) std::memcpy(p + table_offset, table.data(), 16 * S);
+    serial_swap_(p + 8, 2, 4);
+    serial_swap_(p + 16, 2 + 2 * S, 8);
+    for ( uint64_t i = 0; i < S; ++ i ) {
+      if ( sections_[i].size() > 0 ) {
+        std::memcpy(p + table[2*i], sections_[i].data(), sections_[i].size());
+      }
+    }
+    return result;
+  }
+
+private:
+  SerialKind kind_;
+  std::vector<std::string> sections_;
+
+  static uint64_t
+  align_ ( uint64_t x ) {
+    return (x + 63) & ~((uint64_t)63);
+  }
+};
+
+/// Deserializer
+///   Read-only view of one serialized object. "owner" keeps the
+///   underlying memory (a buffer or a file mapping) alive.
+class Deserializer {
+public:
+  Deserializer ( char const* data, uint64_t size, std::shared_ptr<void const> owner )
+               : data_(data), size_(size), owner_(owner) {
+    if ( size_ < 32 || std::memcmp(data_, "PYCHOMP", 8) != 0 ) {
+      throw std::invalid_argument("not a pychomp serialized object");
+    }
+    uint32_t version;
+    read_(&version, 8);
+    if ( version > serialization_version() ) {
+      throw std::invalid_argument("serialized object has unsupported version " + std::to_string(version));
+    }
+    read_(&kind_, 12);
+    uint64_t total;
+    read_(&num_sections_, 16);
+    read_(&total, 24);
+    if ( total > size_ || 32 + 16 * num_sections_ > total ) {
+      throw std::invalid_argument("serialized object is truncated");
+    }
+    size_ = total;
+  }
+
+  /// kind
+  SerialKind
+  kind ( void ) const {
+    return static_cast<SerialKind>(kind_);
+  }
+
+  /// in_place
+  ///   True if arrays may be used in place (see array)
+  static bool
+  in_place ( void ) {
+    return serial_little_endian_();
+  }
+
+  /// array
+  ///   Pointer to section i as an array of T; n is set to its length.
+  ///   The elements are in the byte order of the format, so this is only
+  ///   usable directly if in_place(); otherwise use vector.
+  template < typename T >
+  T const*
+  array ( uint64_t i, uint64_t & n ) const {
+    uint64_t offset, bytes;
+    section_(i, offset, bytes);
+    if ( bytes % sizeof(T) != 0 ) {
+      throw std::invalid_argument("serialized array has wrong element size");
+    }
+    n = bytes / sizeof(T);
+    return reinterpret_cast<T const*>(data_ + offset);
+  }
+
+  /// vector
+  ///   Copy of section i as a vector of T
+  template < typename T >
+  std::vector<T>
+  vector ( uint64_t i ) const {
+    uint64_t n;
+    T const* p = array<T>(i, n);
+    std::vector<T> result ( p, p + n );
+    if ( n > 0 ) serial_swap_(reinterpret_cast<char *>(result.data()), n, sizeof(T));
+    return result;
+  }
+
+  /// object
+  ///   Nested object in section i
+  Deserializer
+  object ( uint64_t i ) const {
+    uint64_t offset, bytes;
+    section_(i, offset, bytes);
+    return Deserializer(data_ + offset, bytes, owner_);
+  }
+
+  /// sections
+  ///   Number of sections
+  uint64_t
+  sections ( void ) const {
+    return num_sections_;
+  }
+
+  /// owner
+  std::shared_ptr<void const>
+  owner ( void ) const {
+    return owner_;
+  }
+
+private:
+  char const* data_;
+  uint64_t size_;
+  std::shared_ptr<void const> owner_;
+  uint32_t kind_;
+  uint64_t num_sections_;
+
+  /// read_
+  ///   Read the header integer at the given position
+  template < typename T >
+  void
+  read_ ( T * x, uint64_t position ) const {
+    std::memcpy(x, data_ + position, sizeof(T));
+    serial_swap_(reinterpret_cast<char *>(x), 1, sizeof(T));
+  }
+
+  void
+  section_ ( uint64_t i, uint64_t & offset, uint64_t & bytes ) const {
+    if ( i >= num_sections_ ) {
+      throw std::invalid_argument("serialized object is missing a section");
+    }
+    read_(&offset, 32 + 16 * i);
+    read_(&bytes, 32 + 16 * i + 8);
+    if ( offset % 64 != 0 || offset > size_ || bytes > size_ - offset ) {
+      throw std::invalid_argument("serialized object is corrupt");
+    }
+  }
+};
+
+/// map_file
+///   Memory-map a file read-only. Returns the mapping (released when the
+///   last copy of the returned pointer goes away) and sets size.
+inline std::shared_ptr<void const>
+map_file ( std::string const& path, uint64_t & size ) {
+#ifdef _WIN32
+  std::ifstream infile ( path, std::ios::binary );
+  if ( not infile ) throw std::runtime_error("cannot open " + path);
+  auto buffer = std::make_shared<std::string>(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+  size = buffer -> size();
+  return std::shared_ptr<void const>(buffer, buffer -> data());
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if ( fd < 0 ) throw std::runtime_error("cannot open " + path);
+  struct stat st;
+  if ( ::fstat(fd, &st) != 0 || st.st_size == 0 ) {
+    ::close(fd);
+    throw std::runtime_error("cannot map " + path);
+  }
+  size = st.st_size;
+  void * p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if ( p == MAP_FAILED ) throw std::runtime_error("cannot map " + path);
+  uint64_t length = size;
+  return std::shared_ptr<void const>(p, [length](void const* q){ ::munmap(const_cast<void*>(q), length); });
+#endif
+}
+
+/// serialize
+inline std::string serialize ( std::shared_ptr<Complex> complex );
+inline std::string serialize ( std::shared_ptr<GradedComplex> graded_complex );
+inline std::string serialize ( std::shared_ptr<MorseMatching> matching );
+
+/// deserialize
+inline std::shared_ptr<Complex> deserialize_complex ( Deserializer const& in );
+inline std::shared_ptr<GradedComplex> deserialize_graded_complex ( Deserializer const& in );
+inline std::shared_ptr<MorseMatching> deserialize_matching ( Deserializer const& in );
+
+/// flatten_ / unflatten_
+///   Convert between ReindexType and a flat array of pairs
+inline std::vector<Integer>
+flatten_reindex_ ( MorseMatching::ReindexType const& reindex ) {
+  std::vector<Integer> result;
+  result.reserve(2 * reindex.size());
+  for ( auto const& pair : reindex ) {
+    result.push_back(pair.first);
+    result.push_back(pair.second);
+  }
+  return result;
+}
+
+inline MorseMatching::ReindexType
+unflatten_reindex_ ( std::vector<Integer> const& flat ) {
+  MorseMatching::ReindexType result ( flat.size() / 2 );
+  for ( uint64_t i = 0; i < result.size(); ++ i ) {
+    result[i] = {flat[2*i], flat[2*i+1]};
+  }
+  return result;
+}
+
+/// check_chains_
+///   Check that offsets and entries describe N chains, each a strictly
+///   increasing list of cells in [0, M)
+inline void
+check_chains_ ( std::vector<Integer> const& offsets,
+                std::vector<Integer> const& entries,
+                Integer N,
+                Integer M ) {
+  if ( (Integer) offsets.size() != N + 1 || offsets[0] != 0 ||
+       offsets[N] != (Integer) entries.size() ) {
+    throw std::invalid_argument("deserialize: boundary offsets do not match");
+  }
+  for ( Integer i = 0; i < N; ++ i ) {
+    if ( offsets[i+1] < offsets[i] || offsets[i+1] > offsets[N] ) {
+      throw std::invalid_argument("deserialize: boundary offsets are not monotone");
+    }
+    for ( Integer k = offsets[i]; k < offsets[i+1]; ++ k ) {
+      if ( entries[k] < 0 || entries[k] >= M || (k > offsets[i] && entries[k] <= entries[k-1]) ) {
+        throw std::invalid_argument("deserialize: boundary entry out of range");
+      }
+    }
+  }
+}
+
+/// check_critical_cells_
+///   Check that begin and reindex describe critical cells of a complex
+///   with N cells
+inline void
+check_critical_cells_ ( MorseMatching::BeginType const& begin,
+                        MorseMatching::ReindexType const& reindex,
+                        Integer N ) {
+  Integer M = reindex.size();
+  if ( begin.size() < 2 || begin[0] != 0 || begin.back() != M ) {
+    throw std::invalid_argument("deserialize: critical cells do not match");
+  }
+  for ( uint64_t d = 0; d + 1 < begin.size(); ++ d ) {
+    if ( begin[d+1] < begin[d] ) {
+      throw std::invalid_argument("deserialize: critical cells are not monotone");
+    }
+  }
+  for ( auto const& pair : reindex ) {
+    if ( pair.first < 0 || pair.first >= N || pair.second < 0 || pair.second >= M ) {
+      throw std::invalid_argument("deserialize: critical cell out of range");
+    }
+  }
+}
+
+/// matching_size_
+///   Number of cells of the complex a matching is on
+inline Integer
+matching_size_ ( std::shared_ptr<MorseMatching> matching ) {
+  if ( auto generic = std::dynamic_pointer_cast<GenericMorseMatching>(matching) ) {
+    return generic -> mates().size();
+  }
+  if ( auto cubical = std::dynamic_pointer_cast<CubicalMorseMatching>(matching) ) {
+    return cubical -> graded_complex() -> complex() -> size();
+  }
+  return -1;
+}
+
+inline std::string
+serialize ( std::shared_ptr<Complex> complex ) {
+  if ( auto cubical = std::dynamic_pointer_cast<CubicalComplex>(complex) ) {
+    Serializer out ( SerialKind::CubicalComplex );
+    out.array(cubical -> boxes());
+    if ( not cubical -> periodic() ) out.array(std::vector<Integer>{1});
+    return out.str();
+  }
+  if ( auto simplicial = std::dynamic_pointer_cast<SimplicialComplex>(complex) ) {
+    Serializer out ( SerialKind::SimplicialComplex );
+    std::vector<Integer> offsets ( 1, 0 ), vertices;
+    for ( Integer d = 0; d <= simplicial -> dimension(); ++ d ) {
+      simplicial -> vertices(d).for_range(0, simplicial -> vertices(d).size(),
+        [&](Integer v){
+          vertices.push_back(v);
+          if ( (Integer) vertices.size() == offsets.back() + d + 1 ) offsets.push_back(vertices.size());
+        });
+    }
+    out.array(offsets);
+    out.array(vertices);
+    out.array(simplicial -> compressed_boundary() -> offsets());
+    out.array(simplicial -> compressed_boundary() -> entries());
+    return out.str();
+  }
+  if ( auto morse = std::dynamic_pointer_cast<MorseComplex>(complex) ) {
+    Serializer out ( SerialKind::MorseComplex );
+    out.object(serialize(morse -> base()));
+    out.object(serialize(morse -> matching()));
+    out.array(morse -> compressed_boundary() -> offsets());
+    out.array(morse -> compressed_boundary() -> entries());
+    return out.str();
+  }
+  throw std::invalid_argument("serialize: unsupported complex type");
+}
+
+inline std::string
+serialize ( std::shared_ptr<GradedComplex> graded_complex ) {
+  Serializer out ( SerialKind::GradedComplex );
+  auto complex = graded_complex -> complex();
+  out.object(serialize(complex));
+  if ( graded_complex -> values() ) {
+    out.array(graded_complex -> values(), complex -> size());
+  } else {
+    std::vector<Integer> values ( complex -> size() );
+    for ( auto x : *complex ) values[x] = graded_complex -> value(x);
+    out.array(values);
+  }
+  return out.str();
+}
+
+inline std::string
+serialize ( std::shared_ptr<MorseMatching> matching ) {
+  auto critical = matching -> critical_cells();
+  if ( auto generic = std::dynamic_pointer_cast<GenericMorseMatching>(matching) ) {
+    Serializer out ( SerialKind::GenericMorseMatching );
+    out.array(generic -> mates());
+    out.array(generic -> priorities());
+    out.array(critical.first);
+    out.array(flatten_reindex_(critical.second));
+    return out.str();
+  }
+  if ( auto cubical = std::dynamic_pointer_cast<CubicalMorseMatching>(matching) ) {
+    Serializer out ( SerialKind::CubicalMorseMatching );
+    out.object(serialize(cubical -> graded_complex()));
+    out.array(critical.first);
+    out.array(flatten_reindex_(critical.second));
+    return out.str();
+  }
+  throw std::invalid_argument("serialize: unsupported matching type");
+}
+
+inline std::shared_ptr<Complex>
+deserialize_complex ( Deserializer const& in ) {
+  switch ( in.kind() ) {
+    case SerialKind::CubicalComplex: {
+      bool periodic = true;
+      if ( in.sections() > 1 ) periodic = not (in.vector<Integer>(1).at(0) & 1);
+      return std::make_shared<CubicalComplex>(in.vector<Integer>(0), periodic);
+    }
+    case SerialKind::SimplicialComplex: {
+      auto offsets = in.vector<Integer>(0);
+      auto vertices = in.vector<Integer>(1);
+      uint64_t n = vertices.size();
+      // simplices are stored by dimension, so split the vertices into
+      // one array per dimension
+      std::vector<IndexArray> simplices;
+      for ( uint64_t i = 0; i + 1 < offsets.size(); ++ i ) {
+        Integer w = offsets[i+1] - offsets[i];
+        if ( offsets[i] < 0 || w < 1 || w < (Integer) simplices.size() || w > (Integer) simplices.size() + 1 ||
+             (uint64_t) offsets[i+1] > n ) {
+          throw std::invalid_argument("deserialize: simplices out of order");
+        }
+        if ( w > (Integer) simplices.size() ) simplices.emplace_back();
+        for ( Integer t = offsets[i]; t < offsets[i+1]; ++ t ) simplices.back().push_back(vertices[t]);
+      }
+      if ( offsets.empty() || offsets[0] != 0 || offsets.back() != (Integer) n ) {
+        throw std::invalid_argument("deserialize: simplices do not match");
+      }
+      Integer N = offsets.size() - 1;
+      auto bd_offsets = in.vector<Integer>(2);
+      auto bd_entries = in.vector<Integer>(3);
+      check_chains_(bd_offsets, bd_entries, N, N);
+      CompressedChains bd ( std::move(bd_offsets), std::move(bd_entries) );
+      return std::make_shared<SimplicialComplex>(std::move(simplices), std::move(bd));
+    }
+    case SerialKind::MorseComplex: {
+      auto base = deserialize_complex(in.object(0));
+      auto matching = deserialize_matching(in.object(1));
+      if ( matching_size_(matching) != base -> size() ) {
+        throw std::invalid_argument("deserialize: matching does not match base complex");
+      }
+      Integer N = matching -> critical_cells().second.size();
+      auto bd_offsets = in.vector<Integer>(2);
+      auto bd_entries = in.vector<Integer>(3);
+      check_chains_(bd_offsets, bd_entries, N, N);
+      CompressedChains bd ( std::move(bd_offsets), std::move(bd_entries) );
+      return std::make_shared<MorseComplex>(base, matching, std::move(bd));
+    }
+    default:
+      throw std::invalid_argument("deserialize: object is not a complex");
+  }
+}
+
+inline std::shared_ptr<GradedComplex>
+deserialize_graded_complex ( Deserializer const& in ) {
+  if ( in.kind() != SerialKind::GradedComplex ) {
+    throw std::invalid_argument("deserialize: object is not a graded complex");
+  }
+  auto complex = deserialize_complex(in.object(0));
+  if ( not Deserializer::in_place() ) {
+    return std::make_shared<GradedComplex>(complex, in.vector<Integer>(1));
+  }
+  uint64_t n;
+  Integer const* values = in.array<Integer>(1, n);
+  if ( (Integer) n != complex -> size() ) {
+    throw std::invalid_argument("deserialize: grading does not match complex");
+  }
+  return std::make_shared<GradedComplex>(complex, values, in.owner());
+}
+
+inline std::shared_ptr<MorseMatching>
+deserialize_matching ( Deserializer const& in ) {
+  switch ( in.kind() ) {
+    case SerialKind::GenericMorseMatching: {
+      auto mate = in.vector<Integer>(0);
+      auto priority = in.vector<Integer>(1);
+      auto begin = in.vector<Integer>(2);
+      auto reindex = unflatten_reindex_(in.vector<Integer>(3));
+      Integer N = mate.size();
+      if ( (Integer) priority.size() != N ) {
+        throw std::invalid_argument("deserialize: priorities do not match mates");
+      }
+      for ( Integer x = 0; x < N; ++ x ) {
+        if ( mate[x] < 0 || mate[x] >= N || mate[mate[x]] != x ) {
+          throw std::invalid_argument("deserialize: mates are not an involution");
+        }
+      }
+      check_critical_cells_(begin, reindex, N);
+      return std::make_shared<GenericMorseMatching>(std::move(mate), std::move(priority),
+        std::move(begin), std::move(reindex));
+    }
+    case SerialKind::CubicalMorseMatching: {
+      auto graded_complex = deserialize_graded_complex(in.object(0));
+      auto begin = in.vector<Integer>(1);
+      auto reindex = unflatten_reindex_(in.vector<Integer>(2));
+      check_critical_cells_(begin, reindex, graded_complex -> complex() -> size());
+      return std::make_shared<CubicalMorseMatching>(graded_complex, std::move(begin), std::move(reindex));
+    }
+    default:
+      throw std::invalid_argument("deserialize: object is not a Morse matching");
+  }
+}
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+namespace py = pybind11;
+
+/// serialize_object
+inline std::string
+serialize_object ( py::object obj ) {
+  if ( py::isinstance<GradedComplex>(obj) ) {
+    auto graded_complex = obj.cast<std::shared_ptr<GradedComplex>>();
+    py::gil_scoped_release release;
+    return serialize(graded_complex);
+  }
+  if ( py::isinstance<Complex>(obj) ) {
+    auto complex = obj.cast<std::shared_ptr<Complex>>();
+    py::gil_scoped_release release;
+    return serialize(complex);
+  }
+  if ( py::isinstance<MorseMatching>(obj) ) {
+    auto matching = obj.cast<std::shared_ptr<MorseMatching>>();
+    py::gil_scoped_release release;
+    return serialize(matching);
+  }
+  throw std::invalid_argument("object cannot be serialized");
+}
+
+/// deserialize_object
+inline py::object
+deserialize_object ( Deserializer const& in ) {
+  switch ( in.kind() ) {
+    case SerialKind::GradedComplex: {
+      std::shared_ptr<GradedComplex> result;
+      {
+        py::gil_scoped_release release;
+        result = deserialize_graded_complex(in);
+      }
+      return py::cast(result);
+    }
+    case SerialKind::GenericMorseMatching:
+    case SerialKind::CubicalMorseMatching: {
+      std::shared_ptr<MorseMatching> result;
+      {
+        py::gil_scoped_release release;
+        result = deserialize_matching(in);
+      }
+      return py::cast(result);
+    }
+    default: {
+      std::shared_ptr<Complex> result;
+      {
+        py::gil_scoped_release release;
+        result = deserialize_complex(in);
+      }
+      return py::cast(result);
+    }
+  }
+}
+
+inline void
+SerializationBinding(py::module &m) {
+  m.def("dumps", [](py::object obj) {
+    return py::bytes(serialize_object(obj));
+  });
+  m.def("loads", [](py::bytes data) {
+    auto buffer = std::make_shared<std::string>(data);
+    Deserializer in ( buffer -> data(), buffer -> size(), buffer );
+    return deserialize_object(in);
+  });
+  m.def("save", [](py::object obj, std::string const& path) {
+    std::string blob = serialize_object(obj);
+    py::gil_scoped_release release;
+    std::ofstream outfile ( path, std::ios::binary );
+    outfile.write(blob.data(), blob.size());
+    if ( not outfile ) throw std::runtime_error("cannot write " + path);
+  });
+  m.def("load", [](std::string const& path) {
+    uint64_t size;
+    auto mapping = map_file(path, size);
+    Deserializer in ( static_cast<char const*>(mapping.get()), size, mapping );
+    return deserialize_object(in);
+  });
+  // Pickle support: instances reduce to loads(dumps(instance))
+  py::object loads = m.attr("loads");
+  for ( auto name : { "CubicalComplex", "SimplicialComplex", "MorseComplex", "GradedComplex",
+                      "GenericMorseMatching", "CubicalMorseMatching" } ) {
+    py::object cls = m.attr(name);
+    cls.attr("__reduce__") = py::cpp_function([loads](py::object self) {
+      return py::make_tuple(loads, py::make_tuple(py::bytes(serialize_object(self))));
+    }, py::is_method(cls));
+  }
+}
@@ -3,12 +3,16 @@
 /// MIT LICENSE
 /// 2018-03-09
 
-// todo: sort simplices upon construction
-
 #pragma once
 
 #include "common.h"
 
+#include "Integer.h"
+#include "IndexArray.h"
+#include "CompressedChains.h"
+#include "Parallel.h"
+#include "Complex.h"
+
 typedef std::vector<Integer> Simplex;
 
 inline std::vector<Simplex>
@@ -27,12 +31,36 @@ simplex_boundary(Simplex const& s) {
 }
 
 /// SimplicialComplex
+///   Cells are the simplices ordered by dimension, then lexicographically.
+///   The vertices of the d-simplices are kept back to back (d+1 per
+///   simplex, in cell order) in one IndexArray per dimension, so a
+///   simplex costs its vertices plus its boundary and coboundary entries;
+///   idx() is a binary search in the array of its dimension.
 class SimplicialComplex : public Complex {
 public:
 
   /// SimplicialComplex
+  ///   Closure of the maximal simplices. Faces are generated, sorted and
+  ///   looked up using up to num_threads() threads; the result does not
+  ///   depend on the number of threads. Faces are generated one dimension
+  ///   at a time and deduplicated before the next, so besides the result
+  ///   the peak memory is about 8(d+2) + 8 bytes per generated (repeated)
+  ///   d-face, for the dimension d with the most of them.
   SimplicialComplex ( std::vector<Simplex> const& maximal_simplices );
 
+  /// SimplicialComplex
+  ///   Complex whose d-simplices have the vertices vertices[d] (see
+  ///   vertices), in lexicographic order. Every face of a simplex must
+  ///   be present.
+  explicit
+  SimplicialComplex ( std::vector<IndexArray> vertices );
+
+  /// SimplicialComplex
+  ///   Restore a complex from the vertices of its simplices of each
+  ///   dimension (see vertices) and its boundary matrix
+  ///   (see Serialization.h)
+  SimplicialComplex ( std::vector<IndexArray> vertices, CompressedChains bd );
+
   /// column
   ///   Apply "callback" method to every element in ith column of
   ///   boundary matrix
@@ -45,6 +73,15 @@ public:
   virtual void
   row ( Integer i, std::function<void(Integer)> const& callback) const final;
 
+  /// signed_column
+  ///   The face without vertex j has coefficient (-1)^j
+  virtual void
+  signed_column ( Integer i, std::function<void(Integer,Integer)> const& callback ) const final;
+
+  /// compressed_boundary
+  virtual CompressedChains const*
+  compressed_boundary ( void ) const final;
+
   /// simplex
   ///   Given a cell index, return the associated Simplex
   Simplex
@@ -56,115 +93,290 @@ public:
   Integer
   idx ( Simplex const& s ) const;
 
+  /// vertices
+  ///   Vertices of the d-simplices, d+1 per simplex, in cell order
+  IndexArray const&
+  vertices ( Integer d ) const {
+    return vertices_[d];
+  }
+
+  /// memory
+  ///   Bytes used by the vertex arrays, boundary and coboundary
+  Integer
+  memory ( void ) const;
+
+  /// bytes_per_simplex
+  double
+  bytes_per_simplex ( void ) const {
+    return size() == 0 ? 0.0 : (double) memory() / size();
+  }
+
 private:
-  std::unordered_map<Simplex, Integer, pychomp::hash<Simplex>> idx_;
-  std::vector<Simplex> simplices_;
-  std::vector<Chain> bd_;
-  std::vector<Chain> cbd_;
-  
-  /// add_simplex
-  bool
-  add_simplex ( Simplex s );
-
-  /// add_closed_simplex
+  std::vector<IndexArray> vertices_;
+  CompressedChains bd_;
+  CompressedChains cbd_;
+
+  /// find_
+  ///   Position among the d-simplices of the simplex with sorted
+  ///   vertices s[0], ..., s[d], or -1 if there is none
+  Integer
+  find_ ( Integer d, Integer const* s ) const;
+
+  /// sorted_simplices_
+  ///   Sort the simplices with w vertices each stored back to back in
+  ///   faces, drop repeats, and release faces
+  static IndexArray
+  sorted_simplices_ ( std::vector<Integer> & faces, Integer w, Integer lo, Integer hi );
+
+  /// set_begin_
+  ///   Set dim_ and begin_ from vertices_
   void
-  add_closed_simplex ( Simplex const& s );
-  
+  set_begin_ ( void );
+
+  /// boundary_
+  ///   Boundary matrix, by looking up the faces of each simplex
+  CompressedChains
+  boundary_ ( void ) const;
 };
 
 inline SimplicialComplex::
 SimplicialComplex (std::vector<Simplex> const& max_simplices) {
-  //std::cout << "SimplicialComplex " << max_simplices.size() << "\n";
-  for ( auto s : max_simplices ) add_closed_simplex ( s );
-  Integer N = simplices_.size();
-  std::sort(simplices_.begin(), simplices_.end(), 
-    []( Simplex const& lhs, Simplex const& rhs ){ 
-      if (lhs.size() < rhs.size()) return true; 
-      if (lhs.size() > rhs.size()) return false;
-      return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
-    });
-  idx_.clear();
-  for ( Integer i = 0; i < N; ++ i ) idx_[simplices_[i]] = i;
-  dim_ = -1;
-  bd_.resize(N);
-  cbd_.resize(N);
-  for ( Integer i = 0; i < N; ++ i ) {
-    Simplex const& s = simplices_[i];
-    Integer simplex_dim = s.size() - 1;
-    // std::cout << "i = " << i << "\n";
-    // std::cout << " s =  ["; for ( auto v : s ) std::cout << v << ", "; std::cout << "] + \n";
-    // std::cout << " simplex_dim == " << simplex_dim << "\n";
-    // std::cout << " dim_ == " << dim_ << "\n";
-    if ( simplex_dim > dim_ ) {
-      // std::cout << "New dimension\n";
-      ++ dim_;
-      begin_.push_back(Iterator(i));
-      // std::cout << "Pushed " << i << " onto begin_\n";
+  // Generate the faces of each maximal simplex as the nonempty subsets
+  // of its vertices, one dimension at a time. The maximal simplices are
+  // cut into T blocks; each block counts its faces of each dimension,
+  // and then writes those of the current dimension at its offset.
+  Integer M = max_simplices.size();
+  std::vector<Simplex> sorted ( M );
+  parallel_for(0, M, [&](Integer i){
+    Simplex & s = sorted[i];
+    s = max_simplices[i];
+    std::sort(s.begin(), s.end());
+    s.erase(std::unique(s.begin(), s.end()), s.end());
+    if ( s.size() > 30 ) {
+      throw std::invalid_argument("SimplicialComplex: simplex has too many vertices");
     }
-    Chain c;
-    for ( Simplex const& t : simplex_boundary(s) ) c += idx_[t];
-    bd_[i] = c;
-    //std::cout << "boundary of " << i << " is equal to " << c << "\n";
+  }, 256);
+  Integer D = 0, lo = 0, hi = 0;
+  for ( auto const& s : sorted ) {
+    if ( s.empty() ) continue;
+    D = std::max<Integer>(D, s.size());
+    lo = std::min(lo, s.front());
+    hi = std::max(hi, s.back());
   }
-  begin_.push_back(Iterator(N));
-  // std::cout << "Pushed " << N << " onto begin_\n";
+  Integer T = std::min<Integer>(num_threads(), std::max<Integer>(1, M / 256));
+  // count[d*T + t]: number of (d+1)-vertex faces from block t
+  std::vector<Integer> count ( D * T, 0 );
+  parallel_for_blocks(0, T, [&](Integer tb, Integer te){
+    for ( Integer t = tb; t < te; ++ t ) {
+      for ( Integer i = (M * t) / T; i < (M * (t+1)) / T; ++ i ) {
+        // a k-vertex simplex has binomial(k, d+1) faces of dimension d
+        Integer k = sorted[i].size(), faces = 1;
+        for ( Integer d = 0; d < k; ++ d ) {
+          faces = faces * (k - d) / (d + 1);
+          count[d*T + t] += faces;
+        }
+      }
+    }
+  }, 1);
+  vertices_.resize(D);
+  for ( Integer d = 0; d < D; ++ d ) {
+    Integer w = d + 1, total = 0;
+    std::vector<Integer> offset ( T );
+    for ( Integer t = 0; t < T; ++ t ) {
+      offset[t] = total;
+      total += count[d*T + t];
+    }
+    std::vector<Integer> faces ( total * w );
+    parallel_for_blocks(0, T, [&](Integer tb, Integer te){
+      for ( Integer t = tb; t < te; ++ t ) {
+        Integer out = offset[t] * w;
+        for ( Integer i = (M * t) / T; i < (M * (t+1)) / T; ++ i ) {
+          Simplex const& s = sorted[i];
+          Integer k = s.size();
+          if ( k < w ) continue;
+          // the w-element subsets of the k vertices, in increasing order
+          // of their bit masks (Gosper's hack)
+          for ( Integer subset = (1L << w) - 1; subset < (1L << k); ) {
+            for ( Integer j = 0; j < k; ++ j ) if ( subset & (1L << j) ) faces[out++] = s[j];
+            Integer c = subset & -subset, r = subset + c;
+            subset = (((r ^ subset) >> 2) / c) | r;
+          }
+        }
+      }
+    }, 1);
+    vertices_[d] = sorted_simplices_(faces, w, lo, hi);
+  }
+  std::vector<Simplex>().swap(sorted);
+  set_begin_ ();
+  bd_ = boundary_ ();
+  cbd_ = bd_.transpose(size());
+}
+
+inline SimplicialComplex::
+SimplicialComplex ( std::vector<IndexArray> vertices ) {
+  vertices_ = std::move(vertices);
+  for ( Integer d = 0; d < (Integer) vertices_.size(); ++ d ) {
+    if ( vertices_[d].size() % (d+1) != 0 ) {
+      throw std::invalid_argument("SimplicialComplex: vertex array has wrong length");
+    }
+  }
+  set_begin_ ();
+  bd_ = boundary_ ();
+  cbd_ = bd_.transpose(size());
+}
 
-  for ( Integer i = 0; i < N; ++ i ) {
-    Chain bd = bd_[i];
-    for ( Integer j : bd ) {
-      cbd_[j] += i;
+inline SimplicialComplex::
+SimplicialComplex ( std::vector<IndexArray> vertices, CompressedChains bd ) {
+  vertices_ = std::move(vertices);
+  for ( Integer d = 0; d < (Integer) vertices_.size(); ++ d ) {
+    if ( vertices_[d].size() % (d+1) != 0 ) {
+      throw std::invalid_argument("SimplicialComplex: vertex array has wrong length");
     }
   }
+  set_begin_ ();
+  if ( bd.size() != size() ) {
+    throw std::invalid_argument("SimplicialComplex: boundary does not match simplices");
+  }
+  bd_ = std::move(bd);
+  cbd_ = bd_.transpose(size());
+}
+
+inline IndexArray SimplicialComplex::
+sorted_simplices_ ( std::vector<Integer> & faces, Integer w, Integer lo, Integer hi ) {
+  Integer n = faces.size() / w;
+  Integer const* f = faces.data();
+  auto less = [&](Integer a, Integer b){
+    return std::lexicographical_compare(f + a*w, f + a*w + w, f + b*w, f + b*w + w);
+  };
+  std::vector<Integer> order ( n );
+  parallel_for(0, n, [&](Integer i){ order[i] = i; });
+  parallel_sort(order.begin(), order.end(), less);
+  // keep the first of each run of equal simplices
+  auto first = [&](Integer i){ return i == 0 || less(order[i-1], order[i]); };
+  std::vector<Integer> position ( n );
+  parallel_for(0, n, [&](Integer i){ position[i] = first(i) ? 1 : 0; });
+  Integer count = parallel_exclusive_scan(position);
+  IndexArray result ( count * w, lo, hi );
+  parallel_for(0, n, [&](Integer i){
+    if ( not first(i) ) return;
+    for ( Integer t = 0; t < w; ++ t ) result.set(position[i]*w + t, f[order[i]*w + t]);
+  });
+  std::vector<Integer>().swap(faces);
+  return result;
+}
+
+inline void SimplicialComplex::
+set_begin_ ( void ) {
+  dim_ = (Integer) vertices_.size() - 1;
+  begin_.clear();
+  Integer N = 0;
+  for ( Integer d = 0; d <= dim_; ++ d ) {
+    begin_.push_back(Iterator(N));
+    N += vertices_[d].size() / (d+1);
+  }
+  begin_.push_back(Iterator(N));
+}
+
+inline CompressedChains SimplicialComplex::
+boundary_ ( void ) const {
+  Integer N = size();
+  std::vector<Integer> offsets ( N+1, 0 );
+  Integer nnz = 0;
+  for ( Integer d = 0; d <= dim_; ++ d ) {
+    Integer b = *begin_[d], w = d > 0 ? d+1 : 0;
+    parallel_for(b, *begin_[d+1], [&](Integer x){ offsets[x+1] = nnz + (x - b + 1) * w; });
+    nnz += (*begin_[d+1] - b) * w;
+  }
+  IndexArray entries ( nnz, 0, N );
+  for ( Integer d = 1; d <= dim_; ++ d ) {
+    IndexArray const& v = vertices_[d];
+    Integer b = *begin_[d];
+    parallel_for_blocks(b, *begin_[d+1], [&](Integer xb, Integer xe){
+      Simplex face ( d );
+      for ( Integer x = xb; x < xe; ++ x ) {
+        Integer i = x - b, k = offsets[x];
+        // dropping vertices from last to first gives the faces in
+        // increasing order, so each column comes out sorted
+        for ( Integer j = d; j >= 0; -- j ) {
+          for ( Integer t = 0, m = 0; t <= d; ++ t ) if ( t != j ) face[m++] = v[i*(d+1) + t];
+          Integer y = find_(d-1, face.data());
+          if ( y == -1 ) {
+            throw std::invalid_argument("SimplicialComplex: simplices are not closed under faces");
+          }
+          entries.set(k++, *begin_[d-1] + y);
+        }
+      }
+    }, 1024);
+  }
+  return CompressedChains(IndexArray(std::move(offsets)), std::move(entries));
+}
+
+inline Integer SimplicialComplex::
+find_ ( Integer d, Integer const* s ) const {
+  IndexArray const& v = vertices_[d];
+  Integer w = d + 1;
+  Integer lo = 0, hi = v.size() / w;
+  while ( lo < hi ) {
+    Integer mid = lo + (hi - lo) / 2;
+    Integer t = 0;
+    while ( t < w && v[mid*w + t] == s[t] ) ++ t;
+    if ( t == w ) return mid;
+    if ( v[mid*w + t] < s[t] ) lo = mid + 1; else hi = mid;
+  }
+  return -1;
 }
 
 inline Simplex SimplicialComplex::
 simplex ( Integer i ) const{
-  return simplices_[i];
+  Integer d = 0;
+  while ( *begin_[d+1] <= i ) ++ d;
+  Integer j = i - *begin_[d];
+  Simplex result ( d+1 );
+  for ( Integer t = 0; t <= d; ++ t ) result[t] = vertices_[d][j*(d+1) + t];
+  return result;
 }
 
 inline Integer SimplicialComplex::
 idx ( Simplex const& s ) const {
-  auto it = idx_.find(s);
-  if ( it == idx_.end() ) return -1;
-  return it -> second;
-}
-
-inline bool SimplicialComplex::
-add_simplex (Simplex s) {
-  std::sort(s.begin(), s.end());
-  if ( idx(s) == -1 ) {
-    idx_[s] = simplices_.size();
-    simplices_.push_back(s);
-    return true;
-  } else {
-    return false;
-  }
+  Simplex t = s;
+  std::sort(t.begin(), t.end());
+  Integer d = (Integer) t.size() - 1;
+  if ( d < 0 || d > dim_ ) return -1;
+  if ( std::adjacent_find(t.begin(), t.end()) != t.end() ) return -1;
+  Integer j = find_(d, t.data());
+  if ( j == -1 ) return -1;
+  return *begin_[d] + j;
 }
 
-inline void SimplicialComplex::
-add_closed_simplex (Simplex const& s) {
-  std::stack < Simplex > work_stack;
-  work_stack.push(s);
-  while ( not work_stack.empty() ) {
-    auto t = work_stack.top();
-    work_stack.pop();
-    bool inserted = add_simplex(t);
-    if ( inserted ) {
-      for ( auto u : simplex_boundary(t) ) {
-        work_stack.push(u);
-      }
-    }
-  }
+inline Integer SimplicialComplex::
+memory ( void ) const {
+  Integer result = bd_.memory() + cbd_.memory();
+  for ( auto const& v : vertices_ ) result += v.memory();
+  return result;
 }
 
 inline void SimplicialComplex::
-column ( Integer i, std::function<void(Integer)> const& callback ) const { 
-  for ( auto x : bd_[i] ) callback(x);
+column ( Integer i, std::function<void(Integer)> const& callback ) const {
+  bd_.for_each(i, callback);
 }
 
 inline void SimplicialComplex::
 row ( Integer i, std::function<void(Integer)> const& callback ) const {
-  for ( auto x : cbd_[i] ) callback(x);
+  cbd_.for_each(i, callback);
+}
+
+inline void SimplicialComplex::
+signed_column ( Integer i, std::function<void(Integer,Integer)> const& callback ) const {
+  // faces come in increasing order, which is that of dropping the
+  // vertices from last to first (see boundary_)
+  Integer d = bd_.offsets()[i+1] - bd_.offsets()[i] - 1;
+  Integer sign = ( d % 2 == 0 ) ? 1 : -1;
+  bd_.for_each(i, [&](Integer y){ callback(y, sign); sign = -sign; });
+}
+
+inline CompressedChains const* SimplicialComplex::
+compressed_boundary ( void ) const {
+  return &bd_;
 }
 
 /// Python Bindings
@@ -178,5 +390,7 @@ SimplicialComplexBinding(py::module &m) {
   py::class_<SimplicialComplex, std::shared_ptr<SimplicialComplex>, Complex>(m, "SimplicialComplex")
     .def(py::init<std::vector<Simplex> const&>())
     .def("simplex", &SimplicialComplex::simplex)
-    .def("idx", &SimplicialComplex::idx);
+    .def("idx", &SimplicialComplex::idx)
+    .def("memory", &SimplicialComplex::memory)
+    .def("bytes_per_simplex", &SimplicialComplex::bytes_per_simplex);
 }
@@ -0,0 +1,294 @@
+/// SmithNormalForm.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <set>
+#include <stdexcept>
+
+#include "Integer.h"
+#include "Progress.h"
+
+/// Coefficients
+///   The ring of coefficients of a chain: the integers (modulus 0), with
+///   overflow checks, or the integers modulo a prime p
+class Coefficients {
+public:
+  /// Coefficients
+  Coefficients ( Integer modulus = 0 ) : p_(modulus) {
+    bool prime = modulus >= 2;
+    for ( Integer k = 2; prime && k * k <= modulus; ++ k ) prime = modulus % k != 0;
+    if ( modulus != 0 && not prime ) {
+      throw std::invalid_argument("Coefficients: modulus must be 0 (the integers) or a prime");
+    }
+  }
+
+  /// modulus
+  Integer
+  modulus ( void ) const {
+    return p_;
+  }
+
+  /// reduce
+  ///   The coefficient represented by the integer a
+  Integer
+  reduce ( Integer a ) const {
+    if ( p_ == 0 ) return a;
+    a %= p_;
+    return a < 0 ? a + p_ : a;
+  }
+
+  /// add
+  Integer
+  add ( Integer a, Integer b ) const {
+    if ( p_ != 0 ) return reduce(a + b);
+    Integer result;
+    if ( __builtin_add_overflow(a, b, &result) ) overflow_();
+    return result;
+  }
+
+  /// mul
+  Integer
+  mul ( Integer a, Integer b ) const {
+    if ( p_ != 0 ) return (Integer) (((__int128) a * b) % p_);
+    Integer result;
+    if ( __builtin_mul_overflow(a, b, &result) ) overflow_();
+    return result;
+  }
+
+  /// neg
+  Integer
+  neg ( Integer a ) const {
+    return p_ == 0 ? mul(a, -1) : reduce(-a);
+  }
+
+  /// unit
+  ///   True if a is invertible
+  bool
+  unit ( Integer a ) const {
+    return p_ == 0 ? ( a == 1 || a == -1 ) : a != 0;
+  }
+
+  /// inverse
+  ///   Inverse of the unit a
+  Integer
+  inverse ( Integer a ) const {
+    if ( p_ == 0 ) return a;
+    Integer result = 1, power = a;
+    for ( Integer e = p_ - 2; e > 0; e >>= 1 ) {
+      if ( e & 1 ) result = mul(result, power);
+      power = mul(power, power);
+    }
+    return result;
+  }
+
+private:
+  Integer p_;
+
+  [[noreturn]] static void
+  overflow_ ( void ) {
+    throw std::overflow_error("Coefficients: integer coefficient overflow");
+  }
+};
+
+/// SparseSmithNormalForm
+///   Diagonalize a sparse matrix over Coefficients by row and column
+///   operations. Invertible pivots are taken first, choosing each time
+///   a column with fewest entries and in it a row with fewest entries,
+///   so as to keep fill-in low (Markowitz pivoting); a column without
+///   one waits until its entries change. Over the integers, whatever is
+///   left (usually a small block) is then reduced with pivots of least
+///   absolute value and division with remainder.
+///   rank() is the number of nonzero diagonal entries, and torsion()
+///   the invariant factors greater than 1, each dividing the next.
+class SparseSmithNormalForm {
+public:
+  /// SparseSmithNormalForm
+  ///   Matrix with the given number of rows and columns whose column j
+  ///   has the entries (i, value) of columns[j] (repeated rows are added)
+  SparseSmithNormalForm ( Integer rows,
+                          std::vector<std::vector<std::pair<Integer,Integer>>> const& columns,
+                          Coefficients const& R )
+                        : R_(R), rows_(rows), cols_(columns.size()), state_(columns.size(), ACTIVE) {
+    for ( Integer j = 0; j < (Integer) columns.size(); ++ j ) {
+      for ( auto const& entry : columns[j] ) {
+        Integer v = R_.add(get_(entry.first, j), R_.reduce(entry.second));
+        set_(entry.first, j, v);
+      }
+    }
+    eliminate_units_();
+    if ( R_.modulus() == 0 ) eliminate_rest_();
+    normalize_();
+  }
+
+  /// rank
+  Integer
+  rank ( void ) const {
+    return rank_;
+  }
+
+  /// torsion
+  std::vector<Integer> const&
+  torsion ( void ) const {
+    return torsion_;
+  }
+
+private:
+  enum { ACTIVE, DEFERRED, DONE };
+  Coefficients R_;
+  std::vector<std::unordered_map<Integer,Integer>> rows_;
+  std::vector<std::unordered_set<Integer>> cols_;
+  std::vector<char> state_;
+  std::set<std::pair<Integer,Integer>> active_;
+  Integer rank_ = 0;
+  std::vector<Integer> torsion_;
+
+  /// get_
+  Integer
+  get_ ( Integer i, Integer j ) const {
+    auto it = rows_[i].find(j);
+    return it == rows_[i].end() ? 0 : it -> second;
+  }
+
+  /// set_
+  ///   Set entry (i, j) to v, keeping the column counts in order
+  void
+  set_ ( Integer i, Integer j, Integer v ) {
+    Integer before = cols_[j].size();
+    if ( v == 0 ) {
+      rows_[i].erase(j);
+      cols_[j].erase(i);
+    } else {
+      rows_[i][j] = v;
+      cols_[j].insert(i);
+    }
+    Integer after = cols_[j].size();
+    if ( state_[j] == ACTIVE ) {
+      active_.erase({before, j});
+      active_.insert({after, j});
+    } else if ( state_[j] == DEFERRED ) {
+      // its entries changed, so it may now have an invertible one
+      state_[j] = ACTIVE;
+      active_.insert({after, j});
+    }
+  }
+
+  /// add_row_
+  ///   row r += f * row i
+  void
+  add_row_ ( Integer r, Integer i, Integer f ) {
+    std::vector<std::pair<Integer,Integer>> source ( rows_[i].begin(), rows_[i].end() );
+    for ( auto const& entry : source ) {
+      set_(r, entry.first, R_.add(get_(r, entry.first), R_.mul(f, entry.second)));
+    }
+  }
+
+  /// add_column_
+  ///   column c += f * column j
+  void
+  add_column_ ( Integer c, Integer j, Integer f ) {
+    std::vector<Integer> source ( cols_[j].begin(), cols_[j].end() );
+    for ( Integer r : source ) set_(r, c, R_.add(get_(r, c), R_.mul(f, get_(r, j))));
+  }
+
+  /// remove_
+  ///   Clear row i of a pivot whose column is otherwise zero (this is done
+  ///   by column operations with the pivot's column, which change nothing
+  ///   else)
+  void
+  remove_ ( Integer i ) {
+    std::vector<Integer> columns;
+    for ( auto const& entry : rows_[i] ) columns.push_back(entry.first);
+    for ( Integer c : columns ) set_(i, c, 0);
+  }
+
+  /// eliminate_units_
+  void
+  eliminate_units_ ( void ) {
+    for ( Integer j = 0; j < (Integer) cols_.size(); ++ j ) active_.insert({(Integer) cols_[j].size(), j});
+    Integer steps = 0;
+    while ( not active_.empty() ) {
+      Integer j = active_.begin() -> second;
+      active_.erase(active_.begin());
+      state_[j] = DONE;
+      report_progress("smith normal form", ++ steps, cols_.size());
+      if ( cols_[j].empty() ) continue;
+      Integer i = -1;
+      for ( Integer r : cols_[j] ) {
+        if ( R_.unit(get_(r, j)) && ( i == -1 || rows_[r].size() < rows_[i].size() ||
+             ( rows_[r].size() == rows_[i].size() && r < i ) ) ) i = r;
+      }
+      if ( i == -1 ) { state_[j] = DEFERRED; continue; }
+      Integer inverse = R_.inverse(get_(i, j));
+      std::vector<Integer> others ( cols_[j].begin(), cols_[j].end() );
+      for ( Integer r : others ) {
+        if ( r != i ) add_row_(r, i, R_.neg(R_.mul(get_(r, j), inverse)));
+      }
+      remove_(i);
+      ++ rank_;
+    }
+  }
+
+  /// eliminate_rest_
+  ///   Integers only: reduce the columns left over, with pivots of least
+  ///   absolute value, until each pivot divides its row and column
+  void
+  eliminate_rest_ ( void ) {
+    std::vector<Integer> rest;
+    for ( Integer j = 0; j < (Integer) cols_.size(); ++ j ) {
+      if ( state_[j] == DEFERRED ) rest.push_back(j);
+      state_[j] = DONE;
+    }
+    while ( true ) {
+      check_progress();
+      Integer i = -1, j = -1, a = 0;
+      for ( Integer c : rest ) {
+        for ( Integer r : cols_[c] ) {
+          Integer v = std::abs(get_(r, c));
+          if ( j == -1 || v < a ) { i = r; j = c; a = v; }
+        }
+      }
+      if ( j == -1 ) break;
+      Integer pivot = get_(i, j);
+      std::vector<Integer> others ( cols_[j].begin(), cols_[j].end() );
+      for ( Integer r : others ) {
+        if ( r != i ) add_row_(r, i, R_.neg(get_(r, j) / pivot));
+      }
+      std::vector<Integer> columns;
+      for ( auto const& entry : rows_[i] ) if ( entry.first != j ) columns.push_back(entry.first);
+      for ( Integer c : columns ) add_column_(c, j, R_.neg(get_(i, c) / pivot));
+      if ( cols_[j].size() == 1 && rows_[i].size() == 1 ) {
+        remove_(i);
+        rest.erase(std::find(rest.begin(), rest.end(), j));
+        ++ rank_;
+        if ( a > 1 ) torsion_.push_back(a);
+      }
+    }
+  }
+
+  /// normalize_
+  ///   Replace the diagonal entries greater than 1 by the invariant
+  ///   factors of the same group
+  void
+  normalize_ ( void ) {
+    auto & d = torsion_;
+    for ( Integer i = 0; i < (Integer) d.size(); ++ i ) {
+      for ( Integer k = i + 1; k < (Integer) d.size(); ++ k ) {
+        Integer g = gcd_(d[i], d[k]);
+        d[k] = R_.mul(d[i] / g, d[k]);
+        d[i] = g;
+      }
+    }
+    d.erase(std::remove(d.begin(), d.end(), 1), d.end());
+  }
+
+  static Integer
+  gcd_ ( Integer a, Integer b ) {
+    while ( b != 0 ) { Integer t = a % b; a = b; b = t; }
+    return a;
+  }
+};
@@ -0,0 +1,201 @@
+/// StreamingConnectionMatrix.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+#pragma once
+
+#include "common.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "Integer.h"
+#include "CubicalComplex.h"
+#include "GradedComplex.h"
+#include "ConnectionMatrix.h"
+#include "TiledConnectionMatrix.h"
+#include "BatchConnectionMatrix.h"
+#include "ImageComplex.h"
+#include "Parallel.h"
+#include "Progress.h"
+#include "Instrumentation.h"
+
+/// StreamingConnectionMatrix
+///   Connection matrices of a sequence of gradings (frames) of one cubical
+///   complex, each given by its top cell values as in TopCellGrading.
+///   Frames pass through a two stage pipeline: a second thread reads and
+///   grades frame t+1 while frame t is reduced. The two per-cell grade
+///   buffers are allocated once and reused for every frame, so only the
+///   reductions themselves (which scale with the critical cells) allocate.
+class StreamingConnectionMatrix {
+public:
+  /// StreamingConnectionMatrix
+  StreamingConnectionMatrix ( std::shared_ptr<CubicalComplex> complex ) : complex_(complex) {
+    for ( auto & grades : grades_ ) grades.resize(complex_ -> size());
+    top_begin_ = *complex_ -> shape_begin((1L << complex_ -> dimension()) - 1);
+  }
+
+  /// complex
+  std::shared_ptr<CubicalComplex>
+  complex ( void ) const {
+    return complex_;
+  }
+
+  /// run
+  ///   Process frames until source returns false, and return how many
+  ///   there were. source(t, top) writes the top cell values of frame t
+  ///   into top[0], ..., top[T-1] and returns true, or returns false if
+  ///   there are no more frames. sink(t, result) receives the connection
+  ///   matrix of each frame, in order. The first exception thrown by
+  ///   either stops the stream and is rethrown. The caller's progress
+  ///   monitor is installed on the second thread too, and both threads
+  ///   poll it once per frame, so cancelling stops the stream.
+  template < typename Source, typename Sink >
+  Integer
+  run ( Source const& source, Sink const& sink ) {
+    StageTimer timer ( "stream" );
+    // slot states
+    enum { EMPTY, FULL, END };
+    Integer state [ 2 ] = { EMPTY, EMPTY };
+    bool stop = false;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable changed;
+    Integer threads = std::max<Integer>(1, num_threads() / 2);
+    ProgressMonitor * monitor = current_progress_monitor ();
+    std::thread producer([&](){
+      ThreadBudget budget ( threads );
+      try {
+        ProgressScope scope ( monitor );
+        for ( Integer t = 0; ; ++ t ) {
+          Integer slot = t % 2;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&](){ return stop || state[slot] == EMPTY; });
+            if ( stop ) return;
+          }
+          poll_progress("stream", t, t);
+          bool more = source(t, grades_[slot].data() + top_begin_);
+          if ( more ) grade_(grades_[slot].data());
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            state[slot] = more ? FULL : END;
+          }
+          changed.notify_all();
+          if ( not more ) return;
+        }
+      } catch ( ... ) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+        changed.notify_all();
+      }
+    });
+    Integer t = 0;
+    try {
+      for ( ; ; ++ t ) {
+        Integer slot = t % 2;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          changed.wait(lock, [&](){ return error || state[slot] != EMPTY; });
+          if ( error || state[slot] == END ) break;
+        }
+        // A function grading, so that the result cache (which would hold
+        // on to the reused buffer) is bypassed
+        Integer const* grades = grades_[slot].data();
+        auto graded_complex = std::make_shared<GradedComplex>(complex_, [grades](Integer x){ return grades[x]; });
+        auto result = std::make_shared<CompactConnectionMatrix>(ConnectionMatrix(graded_complex));
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          state[slot] = EMPTY;
+        }
+        changed.notify_all();
+        sink(t, result);
+        poll_progress("stream", t + 1, t + 1);
+      }
+    } catch ( ... ) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      changed.notify_all();
+      producer.join();
+      throw;
+    }
+    producer.join();
+    if ( error ) std::rethrow_exception(error);
+    return t;
+  }
+
+private:
+  std::shared_ptr<CubicalComplex> complex_;
+  std::vector<Integer> grades_ [ 2 ];
+  Integer top_begin_;
+
+  /// grade_
+  ///   Grade the cells below the top cells (whose values are in place)
+  void
+  grade_ ( Integer * grades ) const {
+    if ( not complex_ -> periodic() ) {
+      cubical_star_grades(*complex_, false, grades);
+      return;
+    }
+    TopCellGrading top ( complex_, grades + top_begin_, nullptr );
+    parallel_for(0, top_begin_, [&](Integer x){ grades[x] = top.value(x); });
+  }
+};
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+namespace py = pybind11;
+
+inline void
+StreamingConnectionMatrixBinding(py::module &m) {
+  py::class_<StreamingConnectionMatrix, std::shared_ptr<StreamingConnectionMatrix>>(m, "StreamingConnectionMatrix")
+    .def(py::init<std::shared_ptr<CubicalComplex>>())
+    .def("complex", &StreamingConnectionMatrix::complex)
+    .def("run", [](StreamingConnectionMatrix & stream, py::object frames, py::object callback, bool betti,
+                   py::object progress, std::shared_ptr<CancellationToken> token, double interval) {
+      // frames : K x T array (e.g. a numpy.memmap) with one row of top cell
+      //   values per frame, or any iterable of arrays of T values
+      // callback(t, result) : result is a CompactConnectionMatrix, or with
+      //   betti=True its count() (generators of each dimension, by grade)
+      Integer T = stream.complex() -> size(stream.complex() -> dimension());
+      auto sink = [&](Integer t, std::shared_ptr<CompactConnectionMatrix> result) {
+        py::gil_scoped_acquire acquire;
+        if ( betti ) callback(t, result -> count()); else callback(t, result);
+      };
+      if ( py::isinstance<py::array>(frames) && frames.cast<py::array>().ndim() == 2 ) {
+        auto values = frames.cast<py::array_t<Integer, py::array::c_style | py::array::forcecast>>();
+        if ( values.shape(1) != T ) throw std::invalid_argument("StreamingConnectionMatrix: frames must have one value per top cell");
+        Integer K = values.shape(0);
+        Integer const* data = values.data();
+        return with_progress(progress, token, interval, [&](){
+          return stream.run([&](Integer t, Integer * top){
+            if ( t == K ) return false;
+            std::memcpy(top, data + t * T, sizeof(Integer) * T);
+            return true;
+          }, sink);
+        });
+      }
+      py::iterator it = py::iter(frames);
+      return with_progress(progress, token, interval, [&](){
+        return stream.run([&](Integer, Integer * top){
+          py::gil_scoped_acquire acquire;
+          if ( not (it != py::iterator::sentinel()) ) return false;
+          auto frame = (*it).cast<py::array_t<Integer, py::array::c_style | py::array::forcecast>>();
+          if ( frame.size() != T ) throw std::invalid_argument("StreamingConnectionMatrix: frames must have one value per top cell");
+          std::memcpy(top, frame.data(), sizeof(Integer) * T);
+          ++ it;
+          return true;
+        }, sink);
+      });
+    }, py::arg("frames"), py::arg("callback"), py::arg("betti") = false, py::arg("progress") = py::none(),
+       py::arg("token") = py::none(), py::arg("interval") = 0.1);
+}
@@ -0,0 +1,577 @@
+/// TiledConnectionMatrix.h
+/// Shaun Harker
+/// 2026-10-18
+/// MIT LICENSE
+
+/// Out-of-core connection matrix computation for cubical complexes graded
+/// by their top cells (the grade of a cell being the minimum over its top
+/// star, as in construct_grading). Grades are computed on demand from the
+/// top cell values, which may be memory-mapped from disk, so no array with
+/// one entry per cell is ever allocated:
+///   1. Critical cells are found tile by tile. Each tile copies the top
+///      cell values it needs (the tile plus a halo of one box on the
+///      left) into a small buffer and runs the cubical matching on it.
+///   2. Morse boundaries are computed in parallel, in tile order; flows
+///      leaving a tile read grades straight from the (mapped) top cell
+///      values.
+/// Only the critical cells and their Morse boundaries are kept. The
+/// result is identical to ConnectionMatrix of the in-memory grading.
+
+#pragma once
+
+#include "common.h"
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+#include "Integer.h"
+#include "Chain.h"
+#include "CompressedChains.h"
+#include "Complex.h"
+#include "CubicalComplex.h"
+#include "GradedComplex.h"
+#include "MorseMatching.h"
+#include "CubicalMorseMatching.h"
+#include "MorseComplex.h"
+#include "MorseGradedComplex.h"
+#include "Parallel.h"
+#include "Progress.h"
+#include "Instrumentation.h"
+#include "Serialization.h"
+
+/// TopCellGrading
+///   Values of the top cells of a CubicalComplex, held in memory owned by
+///   "owner" (e.g. a file mapping). Values must be non-negative.
+class TopCellGrading {
+public:
+  /// TopCellGrading
+  ///   One value per top cell in order of position (first coordinate fastest)
+  TopCellGrading ( std::shared_ptr<CubicalComplex> complex,
+                   Integer const* values,
+                   std::shared_ptr<void const> owner )
+                 : TopCellGrading(complex, values, std::vector<Integer>(), owner) {}
+
+  /// TopCellGrading
+  ///   The value of the top cell with coordinates y is
+  ///   values[y[0]*strides[0] + ... + y[D-1]*strides[D-1]], as in a numpy
+  ///   array of any layout (strides counted in values, possibly negative).
+  ///   Empty strides mean in order of position.
+  TopCellGrading ( std::shared_ptr<CubicalComplex> complex,
+                   Integer const* values,
+                   std::vector<Integer> strides,
+                   std::shared_ptr<void const> owner )
+                 : complex_(complex), values_(values), owner_(owner), strides_(strides) {
+    D_ = complex_ -> dimension();
+    if ( D_ >= 64 ) throw std::invalid_argument("TopCellGrading: dimension too large");
+    place_values_ = complex_ -> PV();
+    size_ = place_values_[D_];
+    if ( strides_.empty() ) strides_.assign(place_values_.begin(), place_values_.begin() + D_);
+    if ( (Integer) strides_.size() != D_ ) {
+      throw std::invalid_argument("TopCellGrading: need one stride per dimension");
+    }
+    contiguous_ = std::equal(strides_.begin(), strides_.end(), place_values_.begin());
+  }
+
+  /// TopCellGrading
+  ///   Map top cell values (native-endian 64-bit integers) from a file,
+  ///   starting "offset" bytes in (e.g. past the header of a .npy file)
+  TopCellGrading ( std::shared_ptr<CubicalComplex> complex,
+                   std::string const& path,
+                   Integer offset = 0 )
+                 : TopCellGrading(complex, nullptr, nullptr) {
+    uint64_t bytes;
+    owner_ = map_file(path, bytes);
+    if ( offset < 0 || offset % sizeof(Integer) != 0 ) {
+      throw std::invalid_argument("TopCellGrading: offset must be a multiple of 8");
+    }
+    if ( bytes < offset + size_ * sizeof(Integer) ) {
+      throw std::invalid_argument("TopCellGrading: " + path + " is too short for the complex");
+    }
+    values_ = reinterpret_cast<Integer const*>(static_cast<char const*>(owner_.get()) + offset);
+  }
+
+  /// complex
+  std::shared_ptr<CubicalComplex>
+  complex ( void ) const {
+    return complex_;
+  }
+
+  /// size
+  ///   Number of top cells
+  Integer
+  size ( void ) const {
+    return size_;
+  }
+
+  /// top_value
+  ///   Value of the top cell with coordinates y[0], ..., y[D-1], which may
+  ///   be one less than the smallest coordinate in any dimension (wrapping
+  ///   around in periodic mode). Returns absent() if there is no such cell.
+  Integer
+  top_value ( Integer const* y ) const {
+    Integer position = 0;
+    if ( complex_ -> periodic() ) {
+      for ( Integer d = 0; d < D_; ++ d ) position += y[d] * place_values_[d];
+      // twisted periodic conditions, as in CubicalComplex::topstar
+      position %= size_;
+      if ( position < 0 ) position += size_;
+      if ( contiguous_ ) return values_[position];
+      Integer offset = 0;
+      for ( Integer d = 0; d < D_; ++ d ) {
+        offset += ((position / place_values_[d]) % complex_ -> boxes()[d]) * strides_[d];
+      }
+      return values_[offset];
+    } else {
+      for ( Integer d = 0; d < D_; ++ d ) {
+        if ( y[d] < 0 || y[d] >= complex_ -> boxes()[d] ) return absent();
+        position += y[d] * strides_[d];
+      }
+    }
+    return values_[position];
+  }
+
+  /// value
+  ///   Grade of a cell: the minimum value over its top star
+  Integer
+  value ( Integer cell ) const {
+    Integer x [ 64 ], y [ 64 ];
+    complex_ -> coordinates(cell, x);
+    Integer free = ~complex_ -> cell_shape(cell) & ((1L << D_) - 1);
+    Integer result = absent();
+    // e runs over subsets of the dimensions without extent
+    for ( Integer e = free; ; e = (e - 1) & free ) {
+      for ( Integer d = 0; d < D_; ++ d ) y[d] = x[d] - ((e >> d) & 1);
+      result = std::min(result, top_value(y));
+      if ( e == 0 ) break;
+    }
+    return result;
+  }
+
+  /// graded_complex
+  ///   The complex graded by value (computed on demand)
+  std::shared_ptr<GradedComplex>
+  graded_complex ( void ) const {
+    TopCellGrading grading ( *this );
+    return std::make_shared<GradedComplex>(complex_, [grading](Integer x){ return grading.value(x); });
+  }
+
+  /// absent
+  ///   Marker for top cells outside the complex
+  static Integer
+  absent ( void ) {
+    return std::numeric_limits<Integer>::max();
+  }
+
+private:
+  std::shared_ptr<CubicalComplex> complex_;
+  Integer const* values_;
+  std::shared_ptr<void const> owner_;
+  std::vector<Integer> strides_;
+  bool contiguous_;
+  Integer D_;
+  Integer size_;
+  std::vector<Integer> place_values_;
+};
+
+/// TopCellGradingTile
+///   Copy of the top cell values needed to grade the cells whose
+///   coordinates lie in the box [lo, hi): the box itself and a halo of
+///   one box on the left in every dimension
+class TopCellGradingTile {
+public:
+  /// TopCellGradingTile
+  TopCellGradingTile ( TopCellGrading const& grading,
+                       std::vector<Integer> const& lo,
+                       std::vector<Integer> const& hi )
+                     : complex_(grading.complex()), lo_(lo) {
+    Integer D = lo.size();
+    place_values_.resize(D + 1);
+    place_values_[0] = 1;
+    for ( Integer d = 0; d < D; ++ d ) place_values_[d+1] = place_values_[d] * (hi[d] - lo[d] + 1);
+    values_.resize(place_values_[D]);
+    Integer y [ 64 ];
+    for ( Integer i = 0; i < (Integer) values_.size(); ++ i ) {
+      for ( Integer d = 0; d < D; ++ d ) y[d] = lo[d] - 1 + (i / place_values_[d]) % (hi[d] - lo[d] + 1);
+      values_[i] = grading.top_value(y);
+    }
+  }
+
+  /// value
+  ///   Grade of a cell with coordinates in the tile (see TopCellGrading::value)
+  Integer
+  value ( Integer cell ) const {
+    Integer D = lo_.size();
+    Integer x [ 64 ];
+    complex_ -> coordinates(cell, x);
+    Integer free = ~complex_ -> cell_shape(cell) & ((1L << D) - 1);
+    Integer corner = 0;
+    for ( Integer d = 0; d < D; ++ d ) corner += (x[d] - lo_[d] + 1) * place_values_[d];
+    Integer result = TopCellGrading::absent();
+    for ( Integer e = free; ; e = (e - 1) & free ) {
+      Integer i = corner;
+      for ( Integer d = 0; d < D; ++ d ) if ( (e >> d) & 1 ) i -= place_values_[d];
+      result = std::min(result, values_[i]);
+      if ( e == 0 ) break;
+    }
+    return result;
+  }
+
+  /// memory
+  ///   Bytes used by the tile
+  Integer
+  memory ( void ) const {
+    return sizeof(Integer) * values_.size();
+  }
+
+private:
+  std::shared_ptr<CubicalComplex> complex_;
+  std::vector<Integer> lo_;
+  std::vector<Integer> place_values_;
+  std::vector<Integer> values_;
+};
+
+/// default_tile
+///   Tile of about 2^16 cells of each shape
+inline std::vector<Integer>
+default_tile ( Integer D ) {
+  Integer edge = std::max<Integer>(1, std::floor(std::pow(65536.0, 1.0 / std::max<Integer>(D, 1))));
+  return std::vector<Integer>(D, edge);
+}
+
+/// cell_extent
+///   Cells have coordinates 0..cell_extent[d]-1 in dimension d:
+///   boxes[d] of them in periodic mode, boxes[d]+1 otherwise
+inline std::vector<Integer>
+cell_extent ( CubicalComplex const& complex ) {
+  std::vector<Integer> extent ( complex.boxes() );
+  if ( not complex.periodic() ) for ( auto & e : extent ) e += 1;
+  return extent;
+}
+
+/// tile_critical_cells
+///   Critical cells (and their grades) of the cubical matching of
+///   grading -> graded_complex() whose coordinates lie in [lo, hi), sorted
+inline std::vector<std::pair<Integer,Integer>>
+tile_critical_cells ( TopCellGrading const& grading,
+                      std::vector<Integer> const& lo,
+                      std::vector<Integer> const& hi ) {
+  auto complex = grading.complex();
+  CubicalComplex const& X = *complex;
+  Integer D = X.dimension();
+  Integer M = 1L << D;
+  bool periodic = X.periodic();
+  std::vector<std::pair<Integer,Integer>> result;
+  auto buffer = std::make_shared<TopCellGradingTile>(grading, lo, hi);
+  auto tile_graded_complex = std::make_shared<GradedComplex>(complex,
+    [buffer](Integer x){ return buffer -> value(x); });
+  CubicalMorseMatching matching ( tile_graded_complex, MorseMatching::BeginType(), MorseMatching::ReindexType() );
+  Integer x [ 64 ];
+  for ( Integer shape = 0; shape < M; ++ shape ) {
+    // coordinates of cells of this shape within the tile
+    Integer const* pv = X.shape_place_values(shape);
+    bool empty = false;
+    for ( Integer d = 0; d < D; ++ d ) {
+      x[d] = lo[d];
+      if ( lo[d] >= std::min(hi[d], pv[d+1] / pv[d]) ) empty = true;
+    }
+    while ( not empty ) {
+      Integer v = X.cell_index(x, shape);
+      if ( not (periodic && X.rightfringe(v)) && matching.mate(v) == v ) {
+        result.push_back({v, buffer -> value(v)});
+      }
+      Integer d = 0;
+      for ( ; d < D; ++ d ) {
+        if ( ++ x[d] < std::min(hi[d], pv[d+1] / pv[d]) ) break;
+        x[d] = lo[d];
+      }
+      if ( d == D ) break;
+    }
+  }
+  std::sort(result.begin(), result.end());
+  Instrumentation::instance().peak("tile memory", buffer -> memory());
+  return result;
+}
+
+/// box_critical_cells
+///   Critical cells (and their grades) with coordinates in [lo, hi),
+///   found tile by tile; one sorted list per tile. Tiles are handed out to
+///   the threads one at a time, and progress is reported per tile.
+inline std::vector<std::vector<std::pair<Integer,Integer>>>
+box_critical_cells ( TopCellGrading const& grading,
+                     std::vector<Integer> const& lo,
+                     std::vector<Integer> const& hi,
+                     std::vector<Integer> tile = std::vector<Integer>() ) {
+  StageTimer timer ( "matching" );
+  Integer D = grading.complex() -> dimension();
+  if ( tile.empty() ) tile = default_tile(D);
+  if ( (Integer) tile.size() != D || (Integer) lo.size() != D || (Integer) hi.size() != D ) {
+    throw std::invalid_argument("box_critical_cells: tile or box has wrong dimension");
+  }
+  for ( auto t : tile ) if ( t <= 0 ) throw std::invalid_argument("box_critical_cells: tile sizes must be positive");
+  auto extent = cell_extent(*grading.complex());
+  for ( Integer d = 0; d < D; ++ d ) {
+    if ( lo[d] < 0 || hi[d] > extent[d] || lo[d] > hi[d] ) {
+      throw std::invalid_argument("box_critical_cells: box is out of range");
+    }
+  }
+  std::vector<Integer> tiles ( D ), tile_place_values ( D + 1, 1 );
+  for ( Integer d = 0; d < D; ++ d ) {
+    tiles[d] = (hi[d] - lo[d] + tile[d] - 1) / tile[d];
+    tile_place_values[d+1] = tile_place_values[d] * tiles[d];
+  }
+  Integer T = tile_place_values[D];
+  std::vector<std::vector<std::pair<Integer,Integer>>> result ( T );
+  std::atomic<Integer> next ( 0 ), done ( 0 );
+  parallel_for_blocks(0, std::min(T, num_threads()), [&](Integer, Integer){
+    std::vector<Integer> tile_lo ( D ), tile_hi ( D );
+    for ( Integer t = next ++; t < T; t = next ++ ) {
+      for ( Integer d = 0; d < D; ++ d ) {
+        tile_lo[d] = lo[d] + ((t / tile_place_values[d]) % tiles[d]) * tile[d];
+        tile_hi[d] = std::min(tile_lo[d] + tile[d], hi[d]);
+      }
+      result[t] = tile_critical_cells(grading, tile_lo, tile_hi);
+      poll_progress("tiled matching", ++ done, T);
+    }
+  }, 1);
+  return result;
+}
+
+/// critical_cell_matching
+///   The cubical matching of grading -> graded_complex(), given all of
+///   its critical cells (sorted)
+inline std::shared_ptr<CubicalMorseMatching>
+critical_cell_matching ( TopCellGrading const& grading,
+                         std::vector<Integer> const& cells ) {
+  CubicalComplex const& X = *grading.complex();
+  Integer D = X.dimension();
+  Integer N = cells.size();
+  // Critical cells in the order CubicalMorseMatching gives them
+  // (by dimension, then by cell index)
+  MorseMatching::BeginType begin ( D + 2 );
+  for ( Integer d = 0; d <= D + 1; ++ d ) {
+    Integer first = (d <= D) ? *X(d).begin() : X.size();
+    begin[d] = std::lower_bound(cells.begin(), cells.end(), first) - cells.begin();
+  }
+  MorseMatching::ReindexType reindex ( N );
+  for ( Integer i = 0; i < N; ++ i ) reindex[i] = {cells[i], i};
+  Instrumentation::instance().add("matching cells", X.size());
+  Instrumentation::instance().add("critical cells", N);
+  return std::make_shared<CubicalMorseMatching>(grading.graded_complex(), begin, reindex);
+}
+
+/// morse_boundaries
+///   Morse boundaries of the given critical cells of the matching, in
+///   terms of its critical cell numbering. The cells are split into
+///   contiguous blocks, one per thread, so cells given in tile order are
+///   flowed tile by tile.
+inline std::vector<Chain>
+morse_boundaries ( std::shared_ptr<CubicalMorseMatching> matching,
+                   std::vector<Integer> const& cells ) {
+  StageTimer timer ( "boundary" );
+  auto complex = matching -> graded_complex() -> complex();
+  Integer N = matching -> critical_cells().second.size();
+  MorseComplex flows ( complex, matching, CompressedChains(std::vector<Chain>(N)) );
+  Integer C = cells.size();
+  std::vector<Chain> result ( C );
+  std::atomic<Integer> done ( 0 );
+  parallel_for(0, C, [&](Integer i){
+    result[i] = flows.lower(complex -> boundary({cells[i]}));
+    report_progress("tiled boundary", ++ done, C);
+  }, 64);
+  return result;
+}
+
+/// CriticalMorseGradedComplex
+///   Assemble the Morse graded complex of a matching from the Morse
+///   boundaries and grades of its critical cells
+inline
+std::shared_ptr<GradedComplex>
+CriticalMorseGradedComplex ( std::shared_ptr<CubicalMorseMatching> matching,
+                             CompressedChains bd,
+                             std::vector<Integer> values ) {
+  auto morse_complex = std::make_shared<MorseComplex>(matching -> graded_complex() -> complex(), matching, std::move(bd));
+  Instrumentation::instance().add("boundary cells", morse_complex -> size());
+  Instrumentation::instance().add("boundary entries", morse_complex -> compressed_boundary() -> nnz());
+  return std::make_shared<GradedComplex>(morse_complex, std::move(values));
+}
+
+/// TiledMorseGradedComplex
+///   Same as MorseGradedComplex(grading -> graded_complex()), but without
+///   holding anything per cell; "tile" gives the tile size in each dimension
+inline
+std::shared_ptr<GradedComplex>
+TiledMorseGradedComplex ( std::shared_ptr<TopCellGrading> grading,
+                          std::vector<Integer> tile = std::vector<Integer>() ) {
+  CubicalComplex const& X = *grading -> complex();
+  std::vector<Integer> lo ( X.dimension(), 0 );
+
+  // 1. Critical cells (with their grades), tile by tile
+  auto critical = box_critical_cells(*grading, lo, cell_extent(X), tile);
+  std::vector<Integer> cells;
+  for ( auto const& in_tile : critical ) {
+    for ( auto const& p : in_tile ) cells.push_back(p.first);
+  }
+  std::sort(cells.begin(), cells.end());
+  Integer N = cells.size();
+  auto matching = critical_cell_matching(*grading, cells);
+
+  // 2. Morse boundaries, tile by tile
+  std::vector<Integer> order, grades;
+  for ( auto & in_tile : critical ) {
+    for ( auto const& p : in_tile ) {
+      order.push_back(p.first);
+      grades.push_back(p.second);
+    }
+    std::vector<std::pair<Integer,Integer>>().swap(in_tile);
+  }
+  auto tile_bd = morse_boundaries(matching, order);
+  std::vector<Chain> bd ( N );
+  std::vector<Integer> values ( N );
+  for ( Integer j = 0; j < N; ++ j ) {
+    Integer i = std::lower_bound(cells.begin(), cells.end(), order[j]) - cells.begin();
+    bd[i] = std::move(tile_bd[j]);
+    values[i] = grades[j];
+  }
+  return CriticalMorseGradedComplex(matching, CompressedChains(bd), std::move(values));
+}
+
+/// TiledConnectionMatrix
+///   Same as ConnectionMatrix(grading -> graded_complex()), computing the
+///   first (largest) Morse reduction out of core
+inline
+std::shared_ptr<GradedComplex>
+TiledConnectionMatrix ( std::shared_ptr<TopCellGrading> grading,
+                        std::vector<Integer> tile = std::vector<Integer>() ) {
+  StageTimer timer ( "connection matrix" );
+  std::shared_ptr<GradedComplex> base = grading -> graded_complex();
+  std::shared_ptr<GradedComplex> next = TiledMorseGradedComplex(grading, tile);
+  Instrumentation::instance().append("critical cells per level", next -> complex() -> size());
+  while ( next -> complex() -> size() != base -> complex() -> size() ) {
+    base = next;
+    next = MorseGradedComplex(base);
+    Instrumentation::instance().append("critical cells per level", next -> complex() -> size());
+  }
+  return base;
+}
+
+/// Python Bindings
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+namespace py = pybind11;
+
+inline void
+TiledConnectionMatrixBinding(py::module &m) {
+  py::class_<TopCellGrading, std::shared_ptr<TopCellGrading>>(m, "TopCellGrading")
+    .def(py::init<std::shared_ptr<CubicalComplex>, std::string const&, Integer>(),
+         py::arg("complex"), py::arg("path"), py::arg("offset") = 0)
+    .def(py::init([](std::shared_ptr<CubicalComplex> complex, py::array values) {
+       // values[x_0, ..., x_{D-1}] (or a flat array in order of position).
+       // An int64 array is used in place through its strides, whatever its
+       // layout, so a numpy.memmap (C or Fortran order) is not read into
+       // memory; arrays of other types are converted to a copy.
+       Integer D = complex -> dimension();
+       std::vector<Integer> const& PV = complex -> PV();
+       bool flat = values.ndim() == 1 && values.shape(0) == PV[D];
+       bool shaped = values.ndim() == D;
+       for ( Integer d = 0; shaped && d < D; ++ d ) shaped = values.shape(d) == complex -> boxes()[d];
+       if ( not flat && not shaped ) {
+         throw std::invalid_argument("TopCellGrading: need one value per top cell, in an array of shape boxes or a flat array");
+       }
+       auto in_place = [](py::array const& a){
+         if ( not py::isinstance<py::array_t<Integer>>(a) ) return false;
+         if ( reinterpret_cast<uintptr_t>(a.data()) % alignof(Integer) != 0 ) return false;
+         for ( Integer d = 0; d < a.ndim(); ++ d ) if ( a.strides(d) % (Integer) sizeof(Integer) != 0 ) return false;
+         return true;
+       };
+       if ( not in_place(values) ) values = py::array_t<Integer, py::array::f_style | py::array::forcecast>::ensure(values);
+       if ( not values ) throw py::error_already_set();
+       std::vector<Integer> strides ( D );
+       for ( Integer d = 0; d < D; ++ d ) {
+         strides[d] = flat ? PV[d] * (values.strides(0) / (Integer) sizeof(Integer))
+                           : values.strides(d) / (Integer) sizeof(Integer);
+       }
+       auto data = static_cast<Integer const*>(values.data());
+       auto handle = new py::object(values);
+       std::shared_ptr<void const> owner ( data, [handle](void const*){
+         py::gil_scoped_acquire acquire;
+         delete handle;
+       });
+       return std::make_shared<TopCellGrading>(complex, data, strides, owner);
+     }), py::arg("complex"), py::arg("values"))
+    .def("complex", &TopCellGrading::complex)
+    .def("size", &TopCellGrading::size)
+    .def("value", &TopCellGrading::value)
+    .def("graded_complex", &TopCellGrading::graded_complex);
+  // Building blocks, for distributing the work (see SlabConnectionMatrix.py)
+  m.def("box_critical_cells", [](std::shared_ptr<TopCellGrading> grading,
+                                 std::vector<Integer> const& lo, std::vector<Integer> const& hi,
+                                 std::vector<Integer> tile) {
+    // Returns (cells, grades), tile by tile
+    std::vector<Integer> cells, grades;
+    {
+      py::gil_scoped_release release;
+      for ( auto const& in_tile : box_critical_cells(*grading, lo, hi, tile) ) {
+        for ( auto const& p : in_tile ) {
+          cells.push_back(p.first);
+          grades.push_back(p.second);
+        }
+      }
+    }
+    return py::make_tuple(as_array(std::move(cells)), as_array(std::move(grades)));
+  }, py::arg("grading"), py::arg("lo"), py::arg("hi"), py::arg("tile") = std::vector<Integer>());
+  m.def("morse_boundaries", [](std::shared_ptr<TopCellGrading> grading, IntegerArray critical_cells, IntegerArray cells) {
+    // Returns (offsets, entries) of the Morse boundaries of "cells", where
+    // critical_cells (sorted) are all critical cells and entries index them
+    std::vector<Integer> all ( critical_cells.data(), critical_cells.data() + critical_cells.size() );
+    std::vector<Integer> which ( cells.data(), cells.data() + cells.size() );
+    std::vector<Integer> offsets, entries;
+    {
+      py::gil_scoped_release release;
+      if ( not std::is_sorted(all.begin(), all.end()) ) {
+        throw std::invalid_argument("morse_boundaries: critical cells must be sorted");
+      }
+      CompressedChains bd ( morse_boundaries(critical_cell_matching(*grading, all), which) );
+      offsets = bd.offsets().to_vector();
+      entries = bd.entries().to_vector();
+    }
+    return py::make_tuple(as_array(std::move(offsets)), as_array(std::move(entries)));
+  }, py::arg("grading"), py::arg("critical_cells"), py::arg("cells"));
+  m.def("CriticalMorseGradedComplex", [](std::shared_ptr<TopCellGrading> grading, IntegerArray critical_cells,
+                                         IntegerArray grades, IntegerArray offsets, IntegerArray entries) {
+    // Morse graded complex from all critical cells (sorted), their grades
+    // and their Morse boundaries (as returned by morse_boundaries)
+    Integer N = critical_cells.size();
+    std::vector<Integer> all ( critical_cells.data(), critical_cells.data() + N );
+    std::vector<Integer> values ( grades.data(), grades.data() + grades.size() );
+    std::vector<Integer> bd_offsets ( offsets.data(), offsets.data() + offsets.size() );
+    std::vector<Integer> bd_entries ( entries.data(), entries.data() + entries.size() );
+    py::gil_scoped_release release;
+    if ( (Integer) values.size() != N || (Integer) bd_offsets.size() != N + 1 || bd_offsets[0] != 0 || bd_offsets[N] != (Integer) bd_entries.size()
+         || not std::is_sorted(bd_offsets.begin(), bd_offsets.end()) || not std::is_sorted(all.begin(), all.end()) ) {
+      throw std::invalid_argument("CriticalMorseGradedComplex: inconsistent arrays");
+    }
+    for ( auto x : bd_entries ) {
+      if ( x < 0 || x >= N ) throw std::invalid_argument("CriticalMorseGradedComplex: boundary entry out of range");
+    }
+    return CriticalMorseGradedComplex(critical_cell_matching(*grading, all),
+                                      CompressedChains(std::move(bd_offsets), std::move(bd_entries)),
+                                      std::move(values));
+  }, py::arg("grading"), py::arg("critical_cells"), py::arg("grades"), py::arg("offsets"), py::arg("entries"));
+  m.def("TiledMorseGradedComplex", [](std::shared_ptr<TopCellGrading> grading, std::vector<Integer> tile,
+                                      py::object progress, std::shared_ptr<CancellationToken> token, double interval) {
+    return with_progress(progress, token, interval, [&](){
+      return TiledMorseGradedComplex(grading, tile);
+    });
+  }, py::arg("grading"), py::arg("tile") = std::vector<Integer>(), py::arg("progress") = py::none(),
+     py::arg("token") = py::none(), py::arg("interval") = 0.1);
+  m.def("TiledConnectionMatrix", [](std::shared_ptr<TopCellGrading> grading, std::vector<Integer> tile,
+                                    py::object progress, std::shared_ptr<CancellationToken> token, double interval) {
+    return with_progress(progress, token, interval, [&](){
+      return TiledConnectionMatrix(grading, tile);
+    });
+  }, py::arg("grading"), py::arg("tile") = std::vector<Integer>(), py::arg("progress") = py::none(),
+     py::arg("token") = py::none(), py::arg("interval") = 0.1);
+}
@@ -0,0 +1,51 @@
+import numpy as np
+import pychomp
+
+def cell(M, x):
+  # follow a generator down the tower of Morse complexes
+  while isinstance(M, pychomp.MorseComplex):
+    x = list(M.include({x}))[0]
+    M = M.base()
+  return x
+
+def assert_same(result, cm):
+  # generator by generator: the cell it comes from, its grade and boundary
+  M = cm.complex()
+  assert result.size() == M.size()
+  assert list(result.cells()) == [ cell(M, x) for x in M ]
+  assert list(result.values()) == [ cm.value(x) for x in M ]
+  for x in M:
+    assert list(result.boundary(x)) == sorted(M.boundary({x})), x
+
+if __name__ == "__main__":
+  rng = np.random.default_rng(44)
+  X = pychomp.CubicalComplex([12, 10, 8])
+  T = X.size(X.dimension())
+  offset = X.size() - T
+  K = 12
+  values = rng.integers(0, 5, size=(K, T))
+  results = pychomp.BatchConnectionMatrix(X, values)
+  for k in range(K):
+    top = values[k]
+    cm = pychomp.ConnectionMatrix(pychomp.GradedComplex(X, pychomp.construct_grading(X, lambda x : int(top[x - offset]))))
+    assert_same(results[k], cm)
+
+  # progress is reported after each grading, from the worker threads
+  # (a poll made while another thread is calling back is skipped)
+  done = []
+  def progress(stage, n, total):
+    if stage == "batch connection matrix":
+      done.append(n)
+  pychomp.BatchConnectionMatrix(X, values, progress=progress, interval=0)
+  assert done and set(done) <= set(range(1, K + 1)), done
+
+  # cancelling from the callback stops the batch
+  token = pychomp.CancellationToken()
+  def cancel(stage, n, total):
+    token.cancel()
+  try:
+    pychomp.BatchConnectionMatrix(X, values, progress=cancel, token=token, interval=0)
+    assert False, "not cancelled"
+  except pychomp.Cancelled:
+    pass
+  print("ok")
@@ -0,0 +1,37 @@
+import random
+import pychomp
+
+def sizes(X):
+  return [X.size(d) for d in range(X.dimension() + 1)]
+
+def boundaries(X):
+  return [sorted(X.boundary({x})) for x in X]
+
+if __name__ == "__main__":
+  default = pychomp.dense_z2_limit()
+  random.seed(49)
+  simplices = [sorted(random.sample(range(20), 3)) for _ in range(120)]
+  complexes = [pychomp.CubicalComplex(boxes, periodic) for periodic in [True, False]
+                                                        for boxes in [[3, 4, 5], [4, 4], [7], [2, 3, 2, 2]]]
+  complexes.append(pychomp.SimplicialComplex(simplices))
+  try:
+    # BettiNumbers gives the sizes of Homology, whichever kernel is used
+    for X in complexes:
+      expected = sizes(pychomp.Homology(X))
+      for limit in [0, 256, 1 << 16, default]:
+        pychomp.set_dense_z2_limit(limit)
+        assert pychomp.BettiNumbers(X) == expected, (limit, pychomp.BettiNumbers(X), expected)
+
+    # dense residual boundaries are the same as sparse ones
+    for periodic in [True, False]:
+      X = pychomp.CubicalComplex([8, 7, 6], periodic)
+      levels = []
+      for limit in [0, default]:
+        pychomp.set_dense_z2_limit(limit)
+        M1 = pychomp.MorseComplex(X)
+        M2 = pychomp.MorseComplex(M1)
+        levels.append([boundaries(M1), boundaries(M2)])
+      assert levels[0] == levels[1]
+  finally:
+    pychomp.set_dense_z2_limit(default)
+  print("ok")
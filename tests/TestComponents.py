@@ -0,0 +1,101 @@
+import random
+import numpy as np
+import pychomp
+
+# ConnectedComponents against BettiNumbers, and ZeroDimensionalPersistence
+# against the components of each sublevel set, with one and several threads
+
+def sublevel_components(X, values, threshold):
+  # union-find over the vertices and edges with value at most threshold
+  vertices = [ v for v in X(0) if values[v] <= threshold ]
+  parent = { v : v for v in vertices }
+  def find(v):
+    while parent[v] != v:
+      v = parent[v]
+    return v
+  if X.dimension() > 0:
+    for e in X(1):
+      if values[e] <= threshold:
+        (u, v) = sorted(X.boundary({e}))
+        parent[find(u)] = find(v)
+  return len({ find(v) for v in vertices })
+
+def check_components(X):
+  expected = pychomp.BettiNumbers(X)[0]
+  (count, labels) = pychomp.ConnectedComponents(X)
+  assert count == expected, (count, expected)
+  assert len(labels) == X.size(X.dimension()) and set(labels) <= set(range(count))
+  # vertices: components are numbered in order of their least vertex, and
+  # the two ends of an edge are in the same one
+  (count, labels) = pychomp.ConnectedComponents(X, 0)
+  assert count == expected
+  first = [ label for (i, label) in enumerate(labels) if label not in labels[:i] ]
+  assert first == list(range(count)), first
+  v0 = min(X(0))
+  for e in (X(1) if X.dimension() > 0 else []):
+    (u, v) = X.boundary({e})
+    assert labels[u - v0] == labels[v - v0]
+  return (count, list(labels))
+
+def check_persistence(G):
+  X = G.complex()
+  values = [ G.value(x) for x in X ]
+  (pairs, essential) = pychomp.ZeroDimensionalPersistence(G)
+  pairs = [ tuple(p) for p in pairs ]
+  assert all(b < d for (b, d) in pairs)
+  assert list(essential) == sorted(essential)
+  assert len(essential) == pychomp.BettiNumbers(X)[0]
+  for threshold in sorted(set(values)):
+    alive = sum(1 for (b, d) in pairs if b <= threshold < d) + sum(1 for b in essential if b <= threshold)
+    assert alive == sublevel_components(X, values, threshold), threshold
+  return (sorted(pairs), list(essential))
+
+def vertex_grading(X, rng):
+  # a closed grading: each cell gets the greatest value over its edges
+  # (or its vertex), each edge a little more than its vertices
+  top = rng.integers(0, 6, size=X.size(0))
+  v0 = min(X(0))
+  values = {}
+  for v in X(0):
+    values[v] = int(top[v - v0])
+  if X.dimension() > 0:
+    for e in X(1):
+      values[e] = max(values[v] for v in X.boundary({e})) + int(rng.integers(0, 3))
+  for d in range(2, X.dimension() + 1):
+    for x in X(d):
+      values[x] = max(values[y] for y in X.boundary({x}))
+  return pychomp.GradedComplex(X, np.array([ values[x] for x in X ], dtype=np.int64))
+
+if __name__ == "__main__":
+  rng = np.random.default_rng(48)
+  random.seed(48)
+  complexes = [ pychomp.CubicalComplex(boxes, periodic) for periodic in [True, False]
+                                                        for boxes in [[3, 4, 5], [4, 4], [7], [2, 3, 2, 2]] ]
+  # several components: simplices on disjoint sets of vertices, and
+  # isolated vertices
+  for pieces in [1, 3, 6]:
+    simplices = []
+    for p in range(pieces):
+      labels = range(10 * p, 10 * p + 6)
+      simplices += [ random.sample(labels, random.randrange(1, 4)) for _ in range(4) ]
+    simplices += [ [100 + i] for i in range(pieces) ]
+    complexes.append(pychomp.SimplicialComplex(simplices))
+  for X in complexes:
+    results = []
+    for threads in [1, 8]:
+      pychomp.set_num_threads(threads)
+      results.append((check_components(X), check_persistence(vertex_grading(X, np.random.default_rng(48)))))
+    assert results[0] == results[1]
+  # top cell gradings of cubical complexes
+  for periodic in [True, False]:
+    X = pychomp.CubicalComplex([6, 5, 4], periodic)
+    top = rng.integers(0, 8, size=X.size(X.dimension()))
+    offset = X.size() - X.size(X.dimension())
+    grading = pychomp.construct_grading(X, lambda x : int(top[x - offset]))
+    G = pychomp.GradedComplex(X, np.array([ grading(x) for x in X ], dtype=np.int64))
+    results = []
+    for threads in [1, 8]:
+      pychomp.set_num_threads(threads)
+      results.append(check_persistence(G))
+    assert results[0] == results[1]
+  print("ok")
@@ -1,5 +1,5 @@
-import chomp
-X = chomp.CubicalComplex([5,5])
+import pychomp
+X = pychomp.CubicalComplex([5,5])
 print(len(X))
 for cell in X:
   print(X.coordinates(cell))
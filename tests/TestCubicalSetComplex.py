@@ -0,0 +1,55 @@
+import numpy as np
+import pychomp
+
+def sizes(X):
+  return [X.size(d) for d in range(X.dimension() + 1)]
+
+def check_boundary(S):
+  # boundaries agree with the ambient complex and square to zero
+  A = S.ambient()
+  for x in S:
+    faces = S.boundary({x})
+    assert sorted(S.ambient_cell(y) for y in faces) == sorted(A.boundary({S.ambient_cell(x)}))
+    counts = {}
+    for y in faces:
+      for z in S.boundary({y}):
+        counts[z] = counts.get(z, 0) + 1
+    assert all(c % 2 == 0 for c in counts.values())
+    for y in faces:
+      assert x in S.coboundary({y})
+
+if __name__ == "__main__":
+  # the full grid has the cells of the non-periodic cubical complex
+  for boxes in [[5], [4, 3], [3, 2, 4]]:
+    S = pychomp.CubicalSetComplex(np.ones(boxes, dtype=bool))
+    assert S.boxes() == boxes
+    assert sizes(S) == sizes(pychomp.CubicalComplex(boxes, False))
+    assert [H for H in sizes(pychomp.Homology(S))] == [1] + [0] * len(boxes)
+    check_boundary(S)
+
+  # an annulus, from a bitmap and from coordinates
+  bitmap = np.ones([5, 5], dtype=bool)
+  bitmap[1:4, 1:4] = False
+  S = pychomp.CubicalSetComplex(bitmap)
+  T = pychomp.CubicalSetComplex([5, 5], np.argwhere(bitmap))
+  assert sizes(S) == sizes(T) == [32, 48, 16]
+  assert all(S.ambient_cell(x) == T.ambient_cell(x) for x in S)
+  assert sizes(pychomp.Homology(S)) == [1, 1, 0]
+  check_boundary(S)
+
+  # two separate boxes
+  S = pychomp.CubicalSetComplex([10, 10], np.array([[0, 0], [7, 8]]))
+  assert sizes(S) == [8, 8, 2]
+  assert sizes(pychomp.Homology(S)) == [2, 0, 0]
+
+  # indexing: cells are ordered by dimension and found by coordinates
+  S = pychomp.CubicalSetComplex(bitmap)
+  for x in S:
+    assert S.index(S.ambient_cell(x)) == x
+    assert S.cell_index(S.coordinates(x), S.cell_shape(x)) == x
+    assert sum(S.cell_shape(x) >> d & 1 for d in range(2)) == S.cell_dim(x)
+  assert S.cell_index([2, 2], 3) == -1      # the hole
+  assert S.cell_index([9, 0], 0) == -1      # outside the grid
+  dims = [S.cell_dim(x) for x in S]
+  assert dims == sorted(dims)
+  print("ok")
@@ -0,0 +1,47 @@
+import itertools
+import math
+import numpy as np
+import pychomp
+
+# FlagComplex against brute-force clique enumeration: the simplices, their
+# order and their grades (the position of the diameter among the levels)
+
+def brute_force(n, distance, radius, max_dimension):
+  edges = [ distance(u, w) for (u, w) in itertools.combinations(range(n), 2) if distance(u, w) <= radius ]
+  levels = [0.0] + (sorted(set(edges)) if max_dimension > 0 else [])
+  cells = []
+  for w in range(1, max_dimension + 2):
+    for s in itertools.combinations(range(n), w):
+      lengths = [ distance(u, v) for (u, v) in itertools.combinations(s, 2) ]
+      if all(d <= radius for d in lengths):
+        cells.append((s, levels.index(max(lengths, default=0.0))))
+  return (cells, levels)
+
+def check(data, distance, radius, distance_matrix):
+  n = data.shape[0]
+  for max_dimension in range(4):
+    (gc, levels) = pychomp.FlagComplex(data, radius, max_dimension, distance_matrix=distance_matrix)
+    (cells, expected_levels) = brute_force(n, distance, radius, max_dimension)
+    assert list(levels) == expected_levels, (max_dimension, levels, expected_levels)
+    K = gc.complex()
+    assert K.size() == len(cells), (max_dimension, K.size(), len(cells))
+    for (x, (s, grade)) in enumerate(cells):
+      assert tuple(K.simplex(x)) == s, (max_dimension, x, K.simplex(x), s)
+      assert gc.value(x) == grade, (max_dimension, s, gc.value(x), grade)
+      # closed: faces have lower or equal grades
+      assert all(gc.value(y) <= grade for y in K.boundary({x}))
+
+if __name__ == "__main__":
+  rng = np.random.default_rng(40)
+  # Euclidean points
+  points = rng.random((24, 3))
+  def euclidean(u, w):
+    return math.sqrt(sum((points[u][i] - points[w][i]) ** 2 for i in range(3)))
+  check(points, euclidean, 0.45, False)
+  # a distance matrix with repeated lengths; only the upper triangle is read
+  n = 20
+  matrix = rng.integers(1, 6, size=(n, n)).astype(float)
+  def lookup(u, w):
+    return matrix[min(u, w)][max(u, w)]
+  check(matrix, lookup, 3.0, True)
+  print("ok")
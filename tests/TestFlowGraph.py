@@ -0,0 +1,100 @@
+import numpy as np
+import pychomp
+
+# FlowGraph against a direct reading of its definition: top cell c has an
+# edge to its neighbor across each wall the flow may cross that way
+
+def neighbor(X, x, d, step):
+  # coordinates of the top cell next to x along d; in periodic mode
+  # positions wrap around as a whole ("twisted"), so stepping right from
+  # the last box in dimension d moves to the first box of the next row
+  boxes = X.boxes()
+  if not X.periodic():
+    y = list(x)
+    y[d] += step
+    return y if 0 <= y[d] < boxes[d] else None
+  PV = [ int(np.prod(boxes[:k])) for k in range(len(boxes)) ]
+  L = int(np.prod(boxes))
+  q = (sum(a * b for (a, b) in zip(x, PV)) + step * PV[d]) % L
+  return [ (q // PV[k]) % boxes[k] for k in range(len(boxes)) ]
+
+def reference(X, sign):
+  # sign(wall) : +1, -1 or 0 as for the FlowGraph constructor
+  D = X.dimension()
+  full = (1 << D) - 1
+  result = {}
+  for c in X(D):
+    x = X.coordinates(c)
+    targets = set()
+    for d in range(D):
+      wall_shape = full ^ (1 << d)
+      # the wall on the left of c has c's coordinates
+      y = neighbor(X, x, d, -1)
+      if y is not None and sign(X.cell_index(x, wall_shape)) <= 0:
+        targets.add(X.cell_index(y, full))
+      # the wall on the right has the right neighbor's coordinates
+      y = neighbor(X, x, d, 1)
+      if y is not None and sign(X.cell_index(y, wall_shape)) >= 0:
+        targets.add(X.cell_index(y, full))
+    targets.discard(c)
+    result[c] = sorted(targets)
+  return result
+
+def check(X, G, sign):
+  D = X.dimension()
+  expected = reference(X, sign)
+  assert G.size() == len(G) == X.size(D)
+  (indptr, indices) = G.csr()
+  first = min(X(D))
+  for c in X(D):
+    assert G(c) == G.adjacencies(c) == expected[c], (c, G(c), expected[c])
+    assert list(indices[indptr[c - first]:indptr[c - first + 1]]) == expected[c]
+  # only top cells have adjacencies
+  for c in [first - 1, X.size(), -1]:
+    try:
+      G(c)
+      assert False, "not rejected"
+    except IndexError:
+      pass
+
+def walls(X):
+  D = X.dimension()
+  return sorted(X(D - 1))
+
+if __name__ == "__main__":
+  rng = np.random.default_rng(47)
+  for periodic in [False, True]:
+    for boxes in [[6, 5], [4, 3, 3], [2, 3], [1, 4]]:
+      X = pychomp.CubicalComplex(boxes, periodic)
+      D = X.dimension()
+      W = walls(X)
+      def normal(wall):
+        return ((1 << D) - 1 ^ X.cell_shape(wall)).bit_length() - 1
+      # a constant field crosses each wall as its normal component says
+      field = rng.integers(-1, 2, size=D).astype(float)
+      G = pychomp.FlowGraph(X, np.tile(field, (X.size(0), 1)))
+      check(X, G, lambda wall : int(np.sign(field[normal(wall)])))
+      # one value per wall, random signs (and NaN for either way)
+      samples = rng.integers(-1, 2, size=len(W)).astype(float)
+      samples[rng.random(len(W)) < 0.1] = np.nan
+      index = { w : i for (i, w) in enumerate(W) }
+      def sign(wall):
+        f = samples[index[wall]]
+        return 1 if f > 0 else (-1 if f < 0 else 0)
+      check(X, pychomp.FlowGraph(X, samples), sign)
+      if periodic:
+        # twisted: the flow runs towards increasing coordinate except
+        # across the walls where the complex wraps around
+        twisted = np.array([ -1.0 if X.coordinates(w)[normal(w)] == 0 else 1.0 for w in W ])
+        G = pychomp.FlowGraph(X, twisted)
+        check(X, G, lambda wall : int(twisted[index[wall]]))
+        # so the last box of each row may be entered from the first box
+        # of the next row, but not left towards it
+        full = (1 << D) - 1
+        for c in X(D):
+          x = X.coordinates(c)
+          for d in range(D):
+            if boxes[d] > 1 and x[d] == boxes[d] - 1:
+              t = X.cell_index(neighbor(X, x, d, 1), full)
+              assert c in G(t)
+  print("ok")
@@ -0,0 +1,44 @@
+import itertools
+import pychomp
+
+def subdivide(triangles):
+  # barycentric subdivision of a 2-dimensional simplicial complex
+  label = {}
+  def vertex(face):
+    return label.setdefault(tuple(sorted(face)), len(label))
+  result = []
+  for t in triangles:
+    for (a, b, c) in itertools.permutations(t):
+      result.append([vertex([a]), vertex([a, b]), vertex([a, b, c])])
+  return result
+
+def groups(X, modulus=0):
+  return [(rank, list(torsion)) for (rank, torsion) in pychomp.HomologyGroups(X, modulus)]
+
+if __name__ == "__main__":
+  rp2 = [[0, 1, 2], [0, 2, 3], [0, 3, 4], [0, 4, 5], [0, 1, 5],
+         [1, 2, 4], [2, 3, 5], [1, 3, 4], [2, 4, 5], [1, 3, 5]]
+  torus = [sorted([i, (i + 1) % 7, (i + 3) % 7]) for i in range(7)] + \
+          [sorted([i, (i + 2) % 7, (i + 3) % 7]) for i in range(7)]
+  # the subdivisions are large enough for Morse rounds to run before the
+  # Smith normal form
+  for triangles in [rp2, subdivide(rp2), subdivide(subdivide(rp2))]:
+    X = pychomp.SimplicialComplex(triangles)
+    assert groups(X) == [(1, []), (0, [2]), (0, [])], groups(X)
+    assert groups(X, 2) == [(1, []), (1, []), (1, [])]
+    assert groups(X, 3) == [(1, []), (0, []), (0, [])]
+    # over Z/2, the ranks are the Betti numbers of Homology
+    assert [rank for (rank, torsion) in groups(X, 2)] == pychomp.BettiNumbers(X)
+  for triangles in [torus, subdivide(torus)]:
+    X = pychomp.SimplicialComplex(triangles)
+    assert groups(X) == [(1, []), (2, []), (1, [])], groups(X)
+    assert groups(X, 5) == [(1, []), (2, []), (1, [])]
+  # a cubical box is acyclic
+  X = pychomp.CubicalComplex([4, 3, 2], False)
+  assert groups(X) == [(1, []), (0, []), (0, []), (0, [])]
+  try:
+    pychomp.HomologyGroups(X, 4)
+    assert False, "composite modulus accepted"
+  except ValueError:
+    pass
+  print("ok")
@@ -0,0 +1,47 @@
+import numpy as np
+import pychomp
+
+# ImageGradedComplex against its definition: the levels are the distinct
+# pixel values in filtration order, and a cell's grade is the least grade
+# over its top star (pixels are top cells) or the greatest grade over its
+# vertices (pixels are vertices)
+
+def check(image, vertices, upper):
+  (gc, levels) = pychomp.ImageGradedComplex(image, vertices=vertices, upper=upper)
+  expected_levels = sorted(set(image.flat), reverse=upper)
+  assert list(levels) == expected_levels, (list(levels), expected_levels)
+  grade = { value : g for (g, value) in enumerate(expected_levels) }
+  X = gc.complex()
+  shape = [ n - 1 for n in image.shape ] if vertices else list(image.shape)
+  assert X.boxes() == list(reversed(shape)) and not X.periodic()
+  # the last axis of the image is the first dimension of the complex
+  def pixel(cell):
+    return grade[image[tuple(reversed(X.coordinates(cell)))]]
+  for x in X:
+    if vertices:
+      expected = max(pixel(v) for v in X.closure({x}) if X.cell_dim(v) == 0)
+    else:
+      expected = min(pixel(t) for t in X.topstar(x))
+    assert gc.value(x) == expected, (image.shape, vertices, upper, x, gc.value(x), expected)
+    # closed: faces have lower or equal grades
+    assert all(gc.value(y) <= gc.value(x) for y in X.boundary({x}))
+
+if __name__ == "__main__":
+  rng = np.random.default_rng(45)
+  for shape in [(5, 4), (2, 3), (3, 4, 2), (2, 3, 2, 3)]:
+    for dtype in [np.uint8, np.float64]:
+      # few distinct values, so that levels are shared
+      image = rng.integers(0, 6, size=shape).astype(dtype)
+      for vertices in [False, True]:
+        for upper in [False, True]:
+          check(image, vertices, upper)
+  # a non-contiguous image is copied
+  image = rng.random((6, 5))
+  check(image.T, False, False)
+  # images with too few pixels for a cube in vertex mode
+  try:
+    pychomp.ImageGradedComplex(np.zeros((1, 4)), vertices=True)
+    assert False, "not rejected"
+  except ValueError:
+    pass
+  print("ok")
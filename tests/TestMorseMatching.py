@@ -0,0 +1,131 @@
+import random
+import pychomp
+
+# Regression tests for the matchings:
+#   - CubicalMorseMatching of an ungraded complex computes its critical
+#     cells (Homology used to crash)
+#   - cubical matchings are symmetric: no cell is paired with a right
+#     fringe cell which does not pair back
+#   - cubical priorities are grade-major, as in GenericMorseMatching, and
+#     raise OverflowError rather than wrap around for huge grades
+#   - GenericMorseMatching matches every cell (a queen matched together
+#     with its king used to be processed again, leaving cells unmatched)
+#   - DualCubicalMorseMatching is a matching of the dual complex with the
+#     same homology and connection matrix sizes as the generic matching,
+#     and rejects periodic complexes
+
+def check_matching(gc, matching):
+  X = gc.complex()
+  for x in X:
+    y = matching.mate(x)
+    assert 0 <= y < X.size(), (x, y)
+    assert matching.mate(y) == x, (x, y, matching.mate(y))
+    if y != x:
+      assert gc.value(x) == gc.value(y)
+      assert y in X.boundary({x}) or x in X.boundary({y})
+
+def check_priorities(gc, matching):
+  X = gc.complex()
+  cells = sorted(X, key=lambda x : gc.value(x))
+  for x, y in zip(cells, cells[1:]):
+    if gc.value(x) < gc.value(y):
+      assert matching.priority(x) < matching.priority(y), (x, y)
+
+def check_boundary_squares_to_zero(X):
+  for x in X:
+    counts = {}
+    for y in X.boundary({x}):
+      for z in X.boundary({y}):
+        counts[z] = counts.get(z, 0) + 1
+    assert all(c % 2 == 0 for c in counts.values()), x
+
+def euler_by_grade(gc, skip=lambda x : False):
+  # nonzero Euler characteristics of the cells of each grade
+  X = gc.complex()
+  result = {}
+  for d in range(X.dimension() + 1):
+    for x in X(d):
+      if not skip(x):
+        result[gc.value(x)] = result.get(gc.value(x), 0) + (-1) ** d
+  return {v : e for v, e in result.items() if e != 0}
+
+if __name__ == "__main__":
+  random.seed(31)
+
+  # ungraded cubical complex
+  X = pychomp.CubicalComplex([4, 5])
+  M = pychomp.CubicalMorseMatching(X)
+  check_matching(pychomp.GradedComplex(X, lambda x : 0), M)
+  H = pychomp.Homology(X)
+  assert H.size() > 0
+
+  # graded periodic cubical complexes, up to 6D
+  for boxes in [[6, 5], [4, 3, 5], [3, 3, 2, 2], [2, 2, 2, 2, 2, 2]]:
+    X = pychomp.CubicalComplex(boxes)
+    top = [random.randrange(4) for _ in range(X.size(X.dimension()))]
+    offset = X.size() - X.size(X.dimension())
+    gc = pychomp.GradedComplex(X, pychomp.construct_grading(X, lambda x : top[x - offset]))
+    M = pychomp.CubicalMorseMatching(gc)
+    check_matching(gc, M)
+    check_priorities(gc, M)
+    cm = pychomp.ConnectionMatrix(gc)
+    check_boundary_squares_to_zero(cm.complex())
+    # periodic cubical matchings leave the right fringe out
+    expected = euler_by_grade(gc, skip=X.rightfringe)
+    found = euler_by_grade(cm)
+    assert expected == found, (boxes, expected, found)
+
+  # grade-major priorities which do not fit in 64 bits
+  for periodic in [True, False]:
+    X = pychomp.CubicalComplex([4, 5], periodic)
+    for grade in [2 ** 62, -2 ** 62]:
+      M = pychomp.CubicalMorseMatching(pychomp.GradedComplex(X, lambda x : grade))
+      try:
+        M.priority(0)
+        assert False, "priority overflow not detected"
+      except OverflowError:
+        pass
+
+  # matchings of duals of non-periodic cubical complexes
+  for boxes in [[5], [4, 5], [3, 4, 5], [3, 3, 3, 2]]:
+    X = pychomp.CubicalComplex(boxes, False)
+    D = pychomp.DualComplex(X)
+    M = pychomp.DualCubicalMorseMatching(D)
+    check_matching(pychomp.GradedComplex(D, lambda x : 0), M)
+    H = pychomp.Homology(pychomp.MorseComplex(D, M))
+    G = pychomp.Homology(pychomp.MorseComplex(D, pychomp.GenericMorseMatching(D)))
+    assert [H.size(d) for d in range(D.dimension() + 1)] == [G.size(d) for d in range(D.dimension() + 1)]
+    # dual of a closed grading of X: dual cell x is cell D.size()-1-x of X
+    top = [random.randrange(4) for _ in range(X.size(X.dimension()))]
+    offset = X.size() - X.size(X.dimension())
+    primal = pychomp.GradedComplex(X, pychomp.construct_grading(X, lambda x : top[x - offset]))
+    last = D.size() - 1
+    gc = pychomp.GradedComplex(D, lambda x : -primal.value(last - x))
+    M = pychomp.DualCubicalMorseMatching(gc)
+    check_matching(gc, M)
+    check_priorities(gc, M)
+    cm = pychomp.ConnectionMatrix(pychomp.MorseGradedComplex(gc, M))
+    check_boundary_squares_to_zero(cm.complex())
+    expected = pychomp.ConnectionMatrix(pychomp.MorseGradedComplex(gc, pychomp.GenericMorseMatching(gc)))
+    assert cm.count() == expected.count(), (boxes, cm.count(), expected.count())
+  try:
+    pychomp.DualCubicalMorseMatching(pychomp.DualComplex(pychomp.CubicalComplex([3, 4])))
+    assert False, "periodic complex accepted"
+  except ValueError:
+    pass
+
+  # generic matchings of graded simplicial complexes
+  for trial in range(10):
+    # pure 2-dimensional, so that every cell lies in a top cell
+    simplices = [sorted(random.sample(range(12), 3)) for _ in range(30)]
+    K = pychomp.SimplicialComplex(simplices)
+    top = [random.randrange(3) for _ in range(K.size(K.dimension()))]
+    offset = K.size() - K.size(K.dimension())
+    gc = pychomp.GradedComplex(K, pychomp.construct_grading(K, lambda x : top[x - offset]))
+    M = pychomp.GenericMorseMatching(gc)
+    check_matching(gc, M)
+    check_priorities(gc, M)
+    cm = pychomp.ConnectionMatrix(gc)
+    check_boundary_squares_to_zero(cm.complex())
+    assert euler_by_grade(gc) == euler_by_grade(cm)
+  print("ok")
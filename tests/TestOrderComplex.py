@@ -0,0 +1,30 @@
+import pychomp
+
+# ImplicitOrderComplex computes its simplices on demand; it must agree
+# with the materialized OrderComplex cell by cell
+
+def check(c):
+  K = pychomp.OrderComplex(c)
+  I = pychomp.ImplicitOrderComplex(c)
+  assert I.size() == K.size() and I.dimension() == K.dimension()
+  for d in range(K.dimension() + 1):
+    assert I.size(d) == K.size(d)
+  for x in K:
+    s = K.simplex(x)
+    assert I.simplex(x) == s, (x, I.simplex(x), s)
+    assert I.idx(s) == x
+    assert I.idx(list(reversed(s))) == x
+    assert I.boundary({x}) == K.boundary({x}), x
+    assert I.coboundary({x}) == K.coboundary({x}), x
+  # cells which are not a chain
+  if c.size(0) > 1:
+    assert I.idx([0, 1]) == -1
+  assert I.idx([]) == -1 and I.idx([c.size()]) == -1
+
+if __name__ == "__main__":
+  for periodic in [True, False]:
+    check(pychomp.CubicalComplex([3, 2], periodic))
+    check(pychomp.CubicalComplex([3, 3, 2], periodic))
+  check(pychomp.SimplicialComplex([[0, 1, 2], [2, 3], [3, 4, 5, 6]]))
+  check(pychomp.SimplicialComplex([[0, 1, 2, 3], [1, 2, 4]]))
+  print("ok")
@@ -0,0 +1,68 @@
+import threading
+import numpy as np
+import pychomp
+
+def graded(X, seed):
+  rng = np.random.default_rng(seed)
+  top = rng.integers(0, 5, size=X.size(X.dimension()))
+  offset = X.size() - X.size(X.dimension())
+  grading = pychomp.construct_grading(X, lambda x : int(top[x - offset]))
+  return pychomp.GradedComplex(X, np.array([grading(x) for x in X], dtype=np.int64))
+
+if __name__ == "__main__":
+  X = pychomp.CubicalComplex([10, 9, 8])
+  expected = [pychomp.ConnectionMatrix(graded(X, seed)).complex().size() for seed in range(3)]
+  pychomp.result_cache_enable(1 << 30)
+  try:
+    # hits for equal values, whatever the grading object
+    a = pychomp.ConnectionMatrix(graded(X, 0))
+    b = pychomp.ConnectionMatrix(graded(X, 0))
+    assert a.complex().size() == b.complex().size() == expected[0]
+    assert pychomp.result_cache_stats()["hits"] > 0
+    # the graded complexes kept alive by the cache are counted, so its
+    # size does not depend on whether the caller still holds them
+    pychomp.result_cache_clear()
+    G = graded(X, 1)
+    assert pychomp.ConnectionMatrix(G).complex().size() == expected[1]
+    stats = pychomp.result_cache_stats()
+    assert stats["bytes"] >= 8 * X.size(), stats
+    del G
+    assert pychomp.result_cache_stats()["bytes"] == stats["bytes"]
+    # the budget is enforced on that count
+    for seed in range(3):
+      assert pychomp.ConnectionMatrix(graded(X, seed)).complex().size() == expected[seed]
+    budget = pychomp.result_cache_stats()["bytes"] // 2
+    pychomp.result_cache_enable(budget)
+    stats = pychomp.result_cache_stats()
+    assert stats["bytes"] <= budget and stats["evictions"] > 0, stats
+    # a caller waiting for another thread's computation can be cancelled;
+    # the computing thread holds in its progress callback until then
+    pychomp.result_cache_enable(1 << 30)
+    pychomp.result_cache_clear()
+    G = graded(X, 2)
+    started = threading.Event()
+    release = threading.Event()
+    def hold(stage, done, total):
+      started.set()
+      release.wait(30)
+    results = []
+    worker = threading.Thread(target=lambda : results.append(pychomp.ConnectionMatrix(G, progress=hold, interval=0)))
+    worker.start()
+    started.wait(30)
+    token = pychomp.CancellationToken()
+    timer = threading.Timer(0.2, token.cancel)
+    timer.start()
+    try:
+      pychomp.ConnectionMatrix(G, token=token)
+      assert False, "not cancelled"
+    except pychomp.Cancelled:
+      pass
+    finally:
+      release.set()
+      worker.join()
+      timer.join()
+    assert results[0].complex().size() == expected[2]
+    assert pychomp.ConnectionMatrix(G).complex().size() == expected[2]
+  finally:
+    pychomp.result_cache_enable(0)
+  print("ok")
@@ -0,0 +1,85 @@
+import os
+import pickle
+import tempfile
+import pychomp
+
+def same_complex(A, B):
+  if type(A) != type(B) or A.size() != B.size() or A.dimension() != B.dimension():
+    return False
+  if any(A.size(d) != B.size(d) for d in range(A.dimension() + 1)):
+    return False
+  return all(A.boundary({x}) == B.boundary({x}) for x in A)
+
+def same_graded(a, b):
+  return same_complex(a.complex(), b.complex()) and all(a.value(x) == b.value(x) for x in a.complex())
+
+def roundtrips(obj):
+  # dumps/loads, save/load (memory-mapped) and pickle
+  with tempfile.TemporaryDirectory() as tmp:
+    path = os.path.join(tmp, "object.chomp")
+    pychomp.save(obj, path)
+    results = [pychomp.loads(pychomp.dumps(obj)), pychomp.load(path), pickle.loads(pickle.dumps(obj))]
+  # loaded objects keep their mapping after the file is removed
+  return results
+
+def corrupt(data, section, index, value):
+  # overwrite element "index" of int64 section "section" of a top-level object
+  entry = 32 + 16 * section
+  offset = int.from_bytes(data[entry:entry+8], "little") + 8 * index
+  return data[:offset] + value.to_bytes(8, "little", signed=True) + data[offset+8:]
+
+def rejected(data):
+  try:
+    pychomp.loads(data)
+    return False
+  except ValueError:
+    return True
+
+if __name__ == "__main__":
+  data = pychomp.dumps(pychomp.CubicalComplex([3, 4]))
+  assert data[0:8] == b"PYCHOMP\0"
+  assert data[8:12] == (1).to_bytes(4, "little")    # version
+  assert data[12:16] == (1).to_bytes(4, "little")   # kind: CubicalComplex
+  assert data[16:24] == (1).to_bytes(8, "little")   # one section (boxes)
+
+  for periodic in [True, False]:
+    X = pychomp.CubicalComplex([4, 3, 5], periodic)
+    for Y in roundtrips(X):
+      assert Y.periodic() == periodic and same_complex(X, Y)
+    G = pychomp.GradedComplex(X, lambda x : (7 * x) % 5)
+    for H in roundtrips(G):
+      assert same_graded(G, H)
+    M = pychomp.MorseComplex(X)
+    for N in roundtrips(M):
+      assert same_complex(M, N)
+    CM = pychomp.ConnectionMatrix(G)
+    for DM in roundtrips(CM):
+      assert same_graded(CM, DM)
+
+  K = pychomp.SimplicialComplex([[0, 1, 2], [1, 2, 3], [3, 4], [5]])
+  for L in roundtrips(K):
+    assert same_complex(K, L)
+  for L in roundtrips(pychomp.MorseComplex(K)):
+    assert same_complex(pychomp.MorseComplex(K), L)
+
+  # inconsistent arrays are rejected rather than used
+  data = pychomp.dumps(K)
+  assert not rejected(data)
+  assert rejected(corrupt(data, 2, 1, 5))          # boundary offsets not monotone
+  assert rejected(corrupt(data, 2, K.size(), 0))   # offsets do not end at the entries
+  assert rejected(corrupt(data, 3, 0, K.size()))   # boundary entry outside the complex
+  assert rejected(corrupt(data, 3, 0, -1))
+  matching = pychomp.GenericMorseMatching(K)
+  data = pychomp.dumps(matching)
+  assert not rejected(data)
+  assert rejected(corrupt(data, 0, 0, K.size()))   # mate out of range
+  y = next(y for y in K if matching.mate(y) != 0)
+  assert rejected(corrupt(data, 0, 0, y))          # mates not an involution
+  assert rejected(corrupt(data, 3, 0, K.size()))   # critical cell outside the complex
+
+  try:
+    pychomp.loads(b"PYCHOMP\0" + (99).to_bytes(4, "little") + bytes(20))
+    assert False, "newer version accepted"
+  except ValueError:
+    pass
+  print("ok")
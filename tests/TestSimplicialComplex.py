@@ -0,0 +1,45 @@
+import itertools
+import random
+import pychomp
+
+# SimplicialComplex against a set-based construction: cells are ordered by
+# dimension, then lexicographically, whatever the number of threads
+
+def reference(maximal_simplices):
+  faces = set()
+  for s in maximal_simplices:
+    s = sorted(set(s))
+    for w in range(1, len(s) + 1):
+      faces.update(itertools.combinations(s, w))
+  return sorted(faces, key=lambda f : (len(f), f))
+
+def check(maximal_simplices):
+  cells = reference(maximal_simplices)
+  index = { f : i for (i, f) in enumerate(cells) }
+  boundary = [ { index[g] for g in itertools.combinations(f, len(f) - 1) } if len(f) > 1 else set()
+               for f in cells ]
+  coboundary = [ set() for f in cells ]
+  for (i, faces) in enumerate(boundary):
+    for j in faces:
+      coboundary[j].add(i)
+  for threads in [1, 8]:
+    pychomp.set_num_threads(threads)
+    K = pychomp.SimplicialComplex(maximal_simplices)
+    assert K.size() == len(cells), (threads, K.size(), len(cells))
+    for (i, f) in enumerate(cells):
+      assert tuple(K.simplex(i)) == f, (threads, i, K.simplex(i), f)
+      assert K.idx(list(f)) == i
+      assert K.idx(list(reversed(f))) == i
+      assert set(K.boundary({i})) == boundary[i]
+      assert set(K.coboundary({i})) == coboundary[i]
+
+if __name__ == "__main__":
+  random.seed(38)
+  check([[3, 1, 2], [2, 5], [7], [1, 1, 4]])
+  for trial in range(10):
+    vertices = random.randrange(5, 60)
+    # enough maximal simplices for several blocks of faces
+    simplices = [ [ random.randrange(vertices) for j in range(random.randrange(1, 6)) ]
+                  for i in range(random.randrange(1, 2000)) ]
+    check(simplices)
+  print("ok")
@@ -0,0 +1,46 @@
+import os
+import numpy as np
+import pychomp
+
+def same(a, b):
+  A = a.complex()
+  B = b.complex()
+  if A.size() != B.size() or A.dimension() != B.dimension():
+    return False
+  for d in range(A.dimension() + 1):
+    if A.size(d) != B.size(d):
+      return False
+  return all(a.value(x) == b.value(x) and A.boundary({x}) == B.boundary({x}) for x in A)
+
+if __name__ == "__main__":
+  rng = np.random.default_rng(0)
+  for periodic in [True, False]:
+    boxes = [8, 7, 9]
+    X = pychomp.CubicalComplex(boxes, periodic)
+    values = rng.integers(0, 4, size=boxes)
+    flat = values.ravel(order='F')
+    expected = pychomp.ConnectionMatrix(pychomp.GradedComplex(X, pychomp.construct_grading(X, lambda v : int(flat[X.cell_pos(v)]))))
+    for processes in [1, 3]:
+      result = pychomp.SlabConnectionMatrix(X, values, processes=processes)
+      assert same(result, expected), (periodic, processes)
+    # a tile smaller than a slab, and more slabs than processes
+    result = pychomp.SlabConnectionMatrix(X, values, slabs=4, processes=2, tile=[3, 3, 2])
+    assert same(result, expected), periodic
+    # flat values of another type
+    result = pychomp.SlabConnectionMatrix(X, flat.astype(np.int32).tolist(), processes=2)
+    assert same(result, expected), periodic
+
+  # a failing worker raises, and no shared memory blocks are left behind
+  def blocks():
+    # names of POSIX shared memory blocks (Linux)
+    shm = "/dev/shm"
+    return { name for name in os.listdir(shm) if name.startswith("psm_") } if os.path.isdir(shm) else set()
+  before = blocks()
+  try:
+    pychomp.SlabConnectionMatrix(X, values, processes=2, tile=[3])
+    assert False, "bad tile accepted"
+  except ValueError:
+    pass
+  after = blocks()
+  assert after <= before, after - before
+  print("ok")
@@ -0,0 +1,53 @@
+import numpy as np
+import pychomp
+
+# StreamingConnectionMatrix gives, frame by frame, the same connection
+# matrices as BatchConnectionMatrix (and so as ConnectionMatrix)
+
+def assert_same(a, b):
+  assert list(a.cells()) == list(b.cells())
+  assert list(a.values()) == list(b.values())
+  for i in range(a.size()):
+    assert list(a.boundary(i)) == list(b.boundary(i)), i
+
+def check(X, frames):
+  expected = pychomp.BatchConnectionMatrix(X, frames)
+  stream = pychomp.StreamingConnectionMatrix(X)
+  # from an array, and from an iterable of frames
+  for source in [frames, iter(list(frames))]:
+    results = []
+    def collect(t, result):
+      assert t == len(results)
+      results.append(result)
+    assert stream.run(source, collect) == len(frames)
+    assert len(results) == len(frames)
+    for (a, b) in zip(results, expected):
+      assert_same(a, b)
+  counts = []
+  stream.run(frames, lambda t, count : counts.append(count), betti=True)
+  assert counts == [ r.count() for r in expected ]
+
+if __name__ == "__main__":
+  rng = np.random.default_rng(46)
+  for periodic in [False, True]:
+    for boxes in [[9, 8], [5, 6, 4]]:
+      X = pychomp.CubicalComplex(boxes, periodic)
+      T = X.size(X.dimension())
+      check(X, rng.integers(0, 5, size=(7, T)))
+
+  # cancelling from the callback stops the stream after that frame
+  X = pychomp.CubicalComplex([8, 8])
+  frames = rng.integers(0, 5, size=(20, X.size(X.dimension())))
+  token = pychomp.CancellationToken()
+  seen = []
+  def cancel(t, result):
+    seen.append(t)
+    if t == 2:
+      token.cancel()
+  try:
+    pychomp.StreamingConnectionMatrix(X).run(frames, cancel, token=token)
+    assert False, "not cancelled"
+  except pychomp.Cancelled:
+    pass
+  assert seen == [0, 1, 2], seen
+  print("ok")
@@ -0,0 +1,59 @@
+import os
+import tempfile
+import numpy as np
+import pychomp
+
+def same(a, b):
+  A = a.complex()
+  B = b.complex()
+  if A.size() != B.size() or A.dimension() != B.dimension():
+    return False
+  return all(a.value(x) == b.value(x) and A.boundary({x}) == B.boundary({x}) for x in A)
+
+if __name__ == "__main__":
+  rng = np.random.default_rng(34)
+  for periodic in [True, False]:
+    for boxes in [[9, 7], [5, 4, 6]]:
+      X = pychomp.CubicalComplex(boxes, periodic)
+      values = rng.integers(0, 4, size=boxes)
+      flat = values.ravel(order='F')
+      G = pychomp.GradedComplex(X, pychomp.construct_grading(X, lambda v : int(flat[X.cell_pos(v)])))
+      expected = pychomp.ConnectionMatrix(G)
+      with tempfile.TemporaryDirectory() as tmp:
+        # a C-ordered memmap, as numpy writes it, is read through its strides
+        mapped = np.lib.format.open_memmap(os.path.join(tmp, "top.npy"), mode="w+", dtype=np.int64, shape=tuple(boxes))
+        mapped[...] = values
+        strided = np.zeros([2 * b for b in boxes], dtype=np.int64)[tuple(slice(None, None, -2) for b in boxes)]
+        strided[...] = values
+        arrays = [mapped, np.asfortranarray(values), flat, strided, values.astype(np.int32)]
+        for array in arrays:
+          grading = pychomp.TopCellGrading(X, array)
+          assert all(grading.value(x) == G.value(x) for x in X)
+          for tile in [[], [2] * len(boxes)]:
+            assert same(pychomp.TiledConnectionMatrix(grading, tile), expected)
+        # a flat file, first coordinate fastest
+        path = os.path.join(tmp, "top.bin")
+        flat.astype(np.int64).tofile(path)
+        assert same(pychomp.TiledConnectionMatrix(pychomp.TopCellGrading(X, path)), expected)
+        del grading, mapped
+
+      try:
+        pychomp.TopCellGrading(X, values.T)
+        assert False, "wrong shape accepted"
+      except ValueError:
+        pass
+
+  # progress is reported from the worker threads, and cancelling stops them
+  X = pychomp.CubicalComplex([24, 24, 24])
+  grading = pychomp.TopCellGrading(X, rng.integers(0, 8, size=[24, 24, 24]))
+  stages = set()
+  pychomp.TiledConnectionMatrix(grading, [4, 4, 4], progress=lambda stage, done, total : stages.add(stage), interval=0)
+  assert "tiled matching" in stages
+  token = pychomp.CancellationToken()
+  token.cancel()
+  try:
+    pychomp.TiledConnectionMatrix(grading, [4, 4, 4], token=token)
+    assert False, "not cancelled"
+  except pychomp.Cancelled:
+    pass
+  print("ok")